@@ -0,0 +1,846 @@
+/******************************************************************************
+ *                                                                            *
+ *                        Ring Buffer Benchmark Harness                       *
+ *                                                                            *
+ * File: bench.c                                                              *
+ * Description:                                                               *
+ *     Measures throughput and producer-to-consumer handoff latency of the   *
+ *     ring buffer variants across element sizes, capacities, batch sizes     *
+ *     and thread placements.                                                 *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_inline.h"
+#include "ring_buffer_mpmc.h"
+#include "ring_buffer_wait.h"
+#include "ring_buffer_typed.h"
+#include "ring_buffer_affinity.h"
+
+/* Default number of messages sent per run */
+#define BENCH_DEFAULT_MESSAGES 200000U
+
+/* Largest batch size in the sweep */
+#define BENCH_MAX_BATCH 32U
+
+/* Element size and capacity of the large-element runs (a 32 MiB ring) */
+#define BENCH_STREAM_ELEMENT_SIZE 4096U
+#define BENCH_STREAM_CAPACITY 8192U
+
+/* Largest element size of any run */
+#define BENCH_MAX_ELEMENT_SIZE BENCH_STREAM_ELEMENT_SIZE
+
+/* Sweep parameters */
+static const size_t bench_element_sizes[] = {8U, 64U, 512U};
+static const uint32_t bench_capacities[] = {64U, 4096U};
+static const uint32_t bench_batches[] = {1U, BENCH_MAX_BATCH};
+
+/* Thread placements: no pinning, both on one core, on two different cores */
+typedef enum
+{
+    BENCH_PIN_NONE,
+    BENCH_PIN_SAME,
+    BENCH_PIN_SPLIT
+} bench_pin_t;
+
+static const char *const bench_pin_names[] = {"none", "same", "split"};
+
+/* Compile-time specialized rings for the 8-byte element runs */
+RING_BUFFER_SPSC_DEFINE(bench_typed64, uint64_t, 64U);
+RING_BUFFER_SPSC_DEFINE(bench_typed4096, uint64_t, 4096U);
+
+/* State shared by the producer and consumer threads of one run */
+typedef struct
+{
+    ring_buffer_t ring;
+    ring_buffer_spsc_t spsc;
+    ring_buffer_mpmc_t mpmc;
+    ring_buffer_waiter_t waiter;
+    bench_typed64_t typed64;
+    bench_typed4096_t typed4096;
+    pthread_mutex_t mutex;
+    uint8_t *storage;
+    size_t element_size;
+    uint32_t capacity;
+    uint32_t batch;
+    uint32_t messages;
+    bench_pin_t pin;
+    uint64_t *latencies;
+} bench_ctx_t;
+
+/* Operations implemented by every benchmarked variant */
+typedef struct
+{
+    const char *name;
+    int batched; /* Supports batches larger than one element */
+    int (*setup)(bench_ctx_t *ctx);
+    uint32_t (*push)(bench_ctx_t *ctx, const uint8_t *elements,
+                     uint32_t count);
+    uint32_t (*pop)(bench_ctx_t *ctx, uint8_t *elements, uint32_t count);
+    void (*finish)(bench_ctx_t *ctx); /* Producer's last call, or NULL */
+    void (*teardown)(bench_ctx_t *ctx);
+} bench_variant_t;
+
+static bench_ctx_t bench_ctx;
+
+/* Read the monotonic clock in nanoseconds */
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* ---------------------------- Mutex variant ------------------------------ */
+
+static int bench_mutex_setup(bench_ctx_t *ctx)
+{
+    (void)memset(&ctx->ring, 0, sizeof(ctx->ring));
+
+    return (ring_buffer_init(&ctx->ring, ctx->element_size, ctx->capacity,
+                             ctx->storage) == RING_BUFFER_OK) ? 0 : -1;
+}
+
+static int bench_mutex_pow2_setup(bench_ctx_t *ctx)
+{
+    (void)memset(&ctx->ring, 0, sizeof(ctx->ring));
+
+    return (ring_buffer_init_pow2(&ctx->ring, ctx->element_size,
+                                  ctx->capacity, ctx->storage) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static uint32_t bench_mutex_push(bench_ctx_t *ctx, const uint8_t *elements,
+                                 uint32_t count)
+{
+    ring_buffer_index_t pushed = 0U;
+
+    (void)pthread_mutex_lock(&ctx->mutex);
+
+    if (count == 1U)
+    {
+        pushed = (ring_buffer_push(&ctx->ring, elements) == RING_BUFFER_OK)
+                     ? 1U : 0U;
+    }
+    else
+    {
+        (void)ring_buffer_push_n(&ctx->ring, elements, count, &pushed);
+    }
+
+    (void)pthread_mutex_unlock(&ctx->mutex);
+
+    return pushed;
+}
+
+static uint32_t bench_mutex_pop(bench_ctx_t *ctx, uint8_t *elements,
+                                uint32_t count)
+{
+    ring_buffer_index_t popped = 0U;
+
+    (void)pthread_mutex_lock(&ctx->mutex);
+
+    if (count == 1U)
+    {
+        popped = (ring_buffer_pop(&ctx->ring, elements) == RING_BUFFER_OK)
+                     ? 1U : 0U;
+    }
+    else
+    {
+        (void)ring_buffer_pop_n(&ctx->ring, elements, count, &popped);
+    }
+
+    (void)pthread_mutex_unlock(&ctx->mutex);
+
+    return popped;
+}
+
+static void bench_mutex_teardown(bench_ctx_t *ctx)
+{
+    (void)ring_buffer_destroy(&ctx->ring);
+}
+
+/* ----------------------------- SPSC variant ------------------------------ */
+
+static int bench_spsc_setup(bench_ctx_t *ctx)
+{
+    (void)memset(&ctx->spsc, 0, sizeof(ctx->spsc));
+
+    return (ring_buffer_spsc_init(&ctx->spsc, ctx->element_size,
+                                  ctx->capacity, ctx->storage) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static int bench_prefetch_setup(bench_ctx_t *ctx)
+{
+    /* Stay four cache lines ahead of the producer */
+    size_t distance = (4U * RING_BUFFER_CACHE_LINE_SIZE) / ctx->element_size;
+
+    if (bench_spsc_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    return (ring_buffer_spsc_set_prefetch_distance(
+                &ctx->spsc, (distance != 0U) ? (ring_buffer_index_t)distance
+                                             : 1U) == RING_BUFFER_OK)
+               ? 0 : -1;
+}
+
+static uint32_t bench_spsc_push(bench_ctx_t *ctx, const uint8_t *elements,
+                                uint32_t count)
+{
+    ring_buffer_index_t pushed = 0U;
+
+    if (count == 1U)
+    {
+        return (ring_buffer_spsc_push(&ctx->spsc, elements) == RING_BUFFER_OK)
+                   ? 1U : 0U;
+    }
+
+    (void)ring_buffer_spsc_push_n(&ctx->spsc, elements, count, &pushed);
+
+    return pushed;
+}
+
+static uint32_t bench_spsc_pop(bench_ctx_t *ctx, uint8_t *elements,
+                               uint32_t count)
+{
+    ring_buffer_index_t popped = 0U;
+
+    if (count == 1U)
+    {
+        return (ring_buffer_spsc_pop(&ctx->spsc, elements) == RING_BUFFER_OK)
+                   ? 1U : 0U;
+    }
+
+    (void)ring_buffer_spsc_pop_n(&ctx->spsc, elements, count, &popped);
+
+    return popped;
+}
+
+static void bench_spsc_teardown(bench_ctx_t *ctx)
+{
+    (void)ring_buffer_spsc_destroy(&ctx->spsc);
+}
+
+/* ------------------------- Deferred SPSC variant ------------------------- */
+
+static int bench_deferred_setup(bench_ctx_t *ctx)
+{
+    if (bench_spsc_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    /* Publish head and tail once per batch instead of per element */
+    return (ring_buffer_spsc_set_publish_batch(&ctx->spsc, ctx->batch,
+                                               ctx->batch) == RING_BUFFER_OK)
+               ? 0 : -1;
+}
+
+static uint32_t bench_deferred_push(bench_ctx_t *ctx, const uint8_t *elements,
+                                    uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    while ((pushed < count) &&
+           (ring_buffer_spsc_push_deferred(
+                &ctx->spsc, &elements[(size_t)pushed * ctx->element_size]) ==
+            RING_BUFFER_OK))
+    {
+        pushed++;
+    }
+
+    return pushed;
+}
+
+static uint32_t bench_deferred_pop(bench_ctx_t *ctx, uint8_t *elements,
+                                   uint32_t count)
+{
+    uint32_t popped = 0U;
+
+    while ((popped < count) &&
+           (ring_buffer_spsc_pop_deferred(
+                &ctx->spsc, &elements[(size_t)popped * ctx->element_size]) ==
+            RING_BUFFER_OK))
+    {
+        popped++;
+    }
+
+    return popped;
+}
+
+static void bench_publish_head(bench_ctx_t *ctx)
+{
+    (void)ring_buffer_spsc_publish_head(&ctx->spsc);
+}
+
+/* ------------------------ Whole-line SPSC pushes ------------------------- */
+
+static int bench_lines_setup(bench_ctx_t *ctx)
+{
+    (void)memset(&ctx->spsc, 0, sizeof(ctx->spsc));
+
+    /* Lines are counted from the buffer, so take a cache-aligned one */
+    return (ring_buffer_spsc_create(&ctx->spsc, ctx->element_size,
+                                    ctx->capacity, NULL) == RING_BUFFER_OK)
+               ? 0 : -1;
+}
+
+static uint32_t bench_lines_push(bench_ctx_t *ctx, const uint8_t *elements,
+                                 uint32_t count)
+{
+    ring_buffer_index_t pushed = 0U;
+
+    (void)ring_buffer_spsc_push_lines(&ctx->spsc, elements, count, &pushed);
+
+    return pushed;
+}
+
+/* ------------------------ Copy kernel comparison ------------------------- */
+
+static int bench_stream_setup(bench_ctx_t *ctx)
+{
+    (void)memset(&ctx->spsc, 0, sizeof(ctx->spsc));
+
+    if (ring_buffer_spsc_create(&ctx->spsc, ctx->element_size, ctx->capacity,
+                                NULL) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    /* Skip the row where the streaming kernel is not available */
+    if (ctx->spsc.stream_in == NULL)
+    {
+        (void)ring_buffer_spsc_destroy(&ctx->spsc);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int bench_memcpy_setup(bench_ctx_t *ctx)
+{
+    if (bench_stream_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    /* Same geometry, plain memcpy() pushes as the baseline */
+    ctx->spsc.stream_in = NULL;
+
+    return 0;
+}
+
+/* ------------------------ Inlined unchecked SPSC ------------------------- */
+
+static uint32_t bench_inline_push(bench_ctx_t *ctx, const uint8_t *elements,
+                                  uint32_t count)
+{
+    (void)count;
+
+    return (ring_buffer_spsc_push_unchecked(&ctx->spsc, elements) ==
+            RING_BUFFER_OK) ? 1U : 0U;
+}
+
+static uint32_t bench_inline_pop(bench_ctx_t *ctx, uint8_t *elements,
+                                 uint32_t count)
+{
+    (void)count;
+
+    return (ring_buffer_spsc_pop_unchecked(&ctx->spsc, elements) ==
+            RING_BUFFER_OK) ? 1U : 0U;
+}
+
+/* ----------------------------- MPMC variant ------------------------------ */
+
+static int bench_mpmc_setup(bench_ctx_t *ctx)
+{
+    (void)memset(&ctx->mpmc, 0, sizeof(ctx->mpmc));
+
+    return (ring_buffer_mpmc_init(&ctx->mpmc, ctx->element_size,
+                                  ctx->capacity, ctx->storage) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static uint32_t bench_mpmc_push(bench_ctx_t *ctx, const uint8_t *elements,
+                                uint32_t count)
+{
+    (void)count;
+
+    return (ring_buffer_mpmc_push(&ctx->mpmc, elements) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static uint32_t bench_mpmc_pop(bench_ctx_t *ctx, uint8_t *elements,
+                               uint32_t count)
+{
+    (void)count;
+
+    return (ring_buffer_mpmc_pop(&ctx->mpmc, elements) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static void bench_mpmc_teardown(bench_ctx_t *ctx)
+{
+    (void)ring_buffer_mpmc_destroy(&ctx->mpmc);
+}
+
+/* ---------------------------- Blocking variant --------------------------- */
+
+static int bench_wait_setup(bench_ctx_t *ctx)
+{
+    if (bench_spsc_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    (void)memset(&ctx->waiter, 0, sizeof(ctx->waiter));
+
+    return (ring_buffer_waiter_init(&ctx->waiter, &ctx->spsc,
+                                    RING_BUFFER_WAIT_DEFAULT_SPIN) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static uint32_t bench_wait_push(bench_ctx_t *ctx, const uint8_t *elements,
+                                uint32_t count)
+{
+    (void)count;
+
+    return (ring_buffer_push_wait(&ctx->waiter, elements,
+                                  RING_BUFFER_WAIT_FOREVER) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static uint32_t bench_wait_pop(bench_ctx_t *ctx, uint8_t *elements,
+                               uint32_t count)
+{
+    (void)count;
+
+    return (ring_buffer_pop_wait(&ctx->waiter, elements,
+                                 RING_BUFFER_WAIT_FOREVER) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static void bench_wait_teardown(bench_ctx_t *ctx)
+{
+    (void)ring_buffer_waiter_destroy(&ctx->waiter);
+    bench_spsc_teardown(ctx);
+}
+
+/* ----------------------------- Typed variant ----------------------------- */
+
+static int bench_typed_setup(bench_ctx_t *ctx)
+{
+    if (ctx->element_size != sizeof(uint64_t))
+    {
+        return -1;
+    }
+
+    if (ctx->capacity == 64U)
+    {
+        bench_typed64_init(&ctx->typed64);
+        return 0;
+    }
+    else if (ctx->capacity == 4096U)
+    {
+        bench_typed4096_init(&ctx->typed4096);
+        return 0;
+    }
+
+    return -1;
+}
+
+static uint32_t bench_typed_push(bench_ctx_t *ctx, const uint8_t *elements,
+                                 uint32_t count)
+{
+    uint64_t element;
+
+    (void)count;
+    (void)memcpy(&element, elements, sizeof(element));
+
+    if (ctx->capacity == 64U)
+    {
+        return (bench_typed64_push(&ctx->typed64, &element) == RING_BUFFER_OK)
+                   ? 1U : 0U;
+    }
+
+    return (bench_typed4096_push(&ctx->typed4096, &element) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static uint32_t bench_typed_pop(bench_ctx_t *ctx, uint8_t *elements,
+                                uint32_t count)
+{
+    uint64_t element;
+    ring_buffer_status_t status;
+
+    (void)count;
+
+    if (ctx->capacity == 64U)
+    {
+        status = bench_typed64_pop(&ctx->typed64, &element);
+    }
+    else
+    {
+        status = bench_typed4096_pop(&ctx->typed4096, &element);
+    }
+
+    if (status != RING_BUFFER_OK)
+    {
+        return 0U;
+    }
+
+    (void)memcpy(elements, &element, sizeof(element));
+
+    return 1U;
+}
+
+static void bench_typed_teardown(bench_ctx_t *ctx)
+{
+    (void)ctx;
+}
+
+/* Table of benchmarked variants */
+static const bench_variant_t bench_variants[] = {
+    {"mutex", 1, bench_mutex_setup, bench_mutex_push, bench_mutex_pop, NULL,
+     bench_mutex_teardown},
+    {"mutex-pow2", 1, bench_mutex_pow2_setup, bench_mutex_push,
+     bench_mutex_pop, NULL, bench_mutex_teardown},
+    {"spsc", 1, bench_spsc_setup, bench_spsc_push, bench_spsc_pop, NULL,
+     bench_spsc_teardown},
+    {"spsc-prefetch", 1, bench_prefetch_setup, bench_spsc_push,
+     bench_spsc_pop, NULL, bench_spsc_teardown},
+    {"spsc-deferred", 1, bench_deferred_setup, bench_deferred_push,
+     bench_deferred_pop, bench_publish_head, bench_spsc_teardown},
+    {"spsc-lines", 1, bench_lines_setup, bench_lines_push, bench_spsc_pop,
+     bench_publish_head, bench_spsc_teardown},
+    {"spsc-inline", 0, bench_spsc_setup, bench_inline_push, bench_inline_pop,
+     NULL, bench_spsc_teardown},
+    {"mpmc", 0, bench_mpmc_setup, bench_mpmc_push, bench_mpmc_pop, NULL,
+     bench_mpmc_teardown},
+    {"spsc-wait", 0, bench_wait_setup, bench_wait_push, bench_wait_pop, NULL,
+     bench_wait_teardown},
+    {"typed-spsc", 0, bench_typed_setup, bench_typed_push, bench_typed_pop,
+     NULL, bench_typed_teardown},
+};
+
+/* Variants run only with large elements in a ring larger than the cache */
+static const bench_variant_t bench_stream_variants[] = {
+    {"spsc-stream", 1, bench_stream_setup, bench_spsc_push, bench_spsc_pop,
+     NULL, bench_spsc_teardown},
+    {"spsc-memcpy", 1, bench_memcpy_setup, bench_spsc_push, bench_spsc_pop,
+     NULL, bench_spsc_teardown},
+};
+
+/* Arguments handed to each benchmark thread */
+typedef struct
+{
+    const bench_variant_t *variant;
+    bench_ctx_t *ctx;
+    int cpu; /* CPU to pin to, or -1 */
+} bench_thread_args_t;
+
+/* Pin the calling benchmark thread to its CPU, if it has one */
+static void bench_pin(const bench_thread_args_t *targs)
+{
+    if ((targs->cpu >= 0) &&
+        (ring_buffer_pin_self((uint32_t)targs->cpu) != RING_BUFFER_OK))
+    {
+        fprintf(stderr, "Failed to pin thread to CPU %d.\n", targs->cpu);
+    }
+}
+
+/**
+ * @brief Producer thread: stamps each element with the send time.
+ *
+ * @param args Pointer to the thread arguments.
+ * @return void* No return value.
+ */
+static void *bench_producer(void *args)
+{
+    bench_thread_args_t *targs = (bench_thread_args_t *)args;
+    bench_ctx_t *ctx = targs->ctx;
+    uint8_t elements[BENCH_MAX_BATCH * BENCH_MAX_ELEMENT_SIZE];
+    uint32_t sent = 0U;
+
+    bench_pin(targs);
+
+    (void)memset(elements, 0, sizeof(elements));
+
+    while (sent < ctx->messages)
+    {
+        uint32_t count = ctx->messages - sent;
+        uint64_t stamp = bench_now_ns();
+
+        count = (count < ctx->batch) ? count : ctx->batch;
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            (void)memcpy(&elements[(size_t)i * ctx->element_size], &stamp,
+                         sizeof(stamp));
+        }
+
+        uint32_t pushed = targs->variant->push(ctx, elements, count);
+
+        if (pushed == 0U)
+        {
+            (void)sched_yield();
+            continue;
+        }
+
+        /* Keep the unsent tail of a partial batch at the front */
+        if (pushed < count)
+        {
+            (void)memmove(elements,
+                          &elements[(size_t)pushed * ctx->element_size],
+                          (size_t)(count - pushed) * ctx->element_size);
+        }
+
+        sent += pushed;
+    }
+
+    if (targs->variant->finish != NULL)
+    {
+        targs->variant->finish(ctx);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Consumer thread: records the dwell time of every element.
+ *
+ * @param args Pointer to the thread arguments.
+ * @return void* No return value.
+ */
+static void *bench_consumer(void *args)
+{
+    bench_thread_args_t *targs = (bench_thread_args_t *)args;
+    bench_ctx_t *ctx = targs->ctx;
+    uint8_t elements[BENCH_MAX_BATCH * BENCH_MAX_ELEMENT_SIZE];
+    uint32_t received = 0U;
+
+    bench_pin(targs);
+
+    while (received < ctx->messages)
+    {
+        uint32_t popped = targs->variant->pop(ctx, elements, ctx->batch);
+
+        if (popped == 0U)
+        {
+            (void)sched_yield();
+            continue;
+        }
+
+        uint64_t now = bench_now_ns();
+
+        for (uint32_t i = 0U; i < popped; i++)
+        {
+            uint64_t stamp;
+
+            (void)memcpy(&stamp, &elements[(size_t)i * ctx->element_size],
+                         sizeof(stamp));
+            ctx->latencies[received + i] = now - stamp;
+        }
+
+        received += popped;
+    }
+
+    return NULL;
+}
+
+/* qsort comparator for latency samples */
+static int bench_compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Get a percentile (in tenths of a percent) from sorted samples */
+static uint64_t bench_percentile(const uint64_t *sorted, uint32_t count,
+                                 uint32_t per_mille)
+{
+    size_t index = ((size_t)count * per_mille) / 1000U;
+
+    return sorted[(index < count) ? index : (count - 1U)];
+}
+
+/* Run one configuration and print a result line */
+static void bench_run(const bench_variant_t *variant, bench_ctx_t *ctx)
+{
+    bench_thread_args_t producer = {variant, ctx, -1};
+    bench_thread_args_t consumer = {variant, ctx, -1};
+    pthread_t producer_tid;
+    pthread_t consumer_tid;
+
+    if (variant->setup(ctx) != 0)
+    {
+        return;
+    }
+
+    if (ctx->pin == BENCH_PIN_SAME)
+    {
+        producer.cpu = 0;
+        consumer.cpu = 0;
+    }
+    else if (ctx->pin == BENCH_PIN_SPLIT)
+    {
+        producer.cpu = 0;
+        consumer.cpu = 1;
+    }
+
+    uint64_t start = bench_now_ns();
+
+    if (pthread_create(&consumer_tid, NULL, bench_consumer, &consumer) != 0)
+    {
+        variant->teardown(ctx);
+        return;
+    }
+
+    if (pthread_create(&producer_tid, NULL, bench_producer, &producer) != 0)
+    {
+        (void)pthread_cancel(consumer_tid);
+        (void)pthread_join(consumer_tid, NULL);
+        variant->teardown(ctx);
+        return;
+    }
+
+    (void)pthread_join(producer_tid, NULL);
+    (void)pthread_join(consumer_tid, NULL);
+
+    uint64_t elapsed = bench_now_ns() - start;
+
+    variant->teardown(ctx);
+
+    qsort(ctx->latencies, ctx->messages, sizeof(uint64_t), bench_compare_u64);
+
+    printf("%-12s %6zu %6u %5u %-5s %10.2f %10llu %10llu %10llu\n",
+           variant->name, ctx->element_size, ctx->capacity, ctx->batch,
+           bench_pin_names[ctx->pin],
+           ((double)ctx->messages * 1000.0) / (double)elapsed,
+           (unsigned long long)bench_percentile(ctx->latencies,
+                                                ctx->messages, 500U),
+           (unsigned long long)bench_percentile(ctx->latencies,
+                                                ctx->messages, 990U),
+           (unsigned long long)bench_percentile(ctx->latencies,
+                                                ctx->messages, 999U));
+    (void)fflush(stdout);
+}
+
+/* Run one geometry across batch sizes and thread placements */
+static void bench_sweep(const bench_variant_t *variant, bench_ctx_t *ctx,
+                        size_t element_size, uint32_t capacity, long cpus)
+{
+    for (size_t b = 0U;
+         b < (sizeof(bench_batches) / sizeof(bench_batches[0])); b++)
+    {
+        if ((variant->batched == 0) && (bench_batches[b] != 1U))
+        {
+            continue;
+        }
+
+        for (int p = BENCH_PIN_NONE; p <= BENCH_PIN_SPLIT; p++)
+        {
+            if ((p == BENCH_PIN_SPLIT) && (cpus < 2))
+            {
+                continue;
+            }
+
+            ctx->element_size = element_size;
+            ctx->capacity = capacity;
+            ctx->batch = bench_batches[b];
+            ctx->pin = (bench_pin_t)p;
+            bench_run(variant, ctx);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench_ctx_t *ctx = &bench_ctx;
+    uint32_t messages = BENCH_DEFAULT_MESSAGES;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (argc > 1)
+    {
+        messages = (uint32_t)strtoul(argv[1], NULL, 10);
+
+        if (messages == 0U)
+        {
+            printf("Usage: %s [messages]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    ctx->messages = messages;
+    ctx->latencies = malloc((size_t)messages * sizeof(uint64_t));
+    ctx->storage = malloc(RING_BUFFER_MPMC_BUFFER_SIZE(
+        bench_element_sizes[2], bench_capacities[1]));
+
+    if ((ctx->latencies == NULL) || (ctx->storage == NULL) ||
+        (pthread_mutex_init(&ctx->mutex, NULL) != 0))
+    {
+        printf("Failed to allocate benchmark state.\n");
+        free(ctx->latencies);
+        free(ctx->storage);
+        return -1;
+    }
+
+    printf("Ring buffer benchmark: %u messages per run, %ld CPU(s)\n",
+           messages, cpus);
+    printf("%-12s %6s %6s %5s %-5s %10s %10s %10s %10s\n", "variant",
+           "elem", "cap", "batch", "pin", "Mops/s", "p50(ns)", "p99(ns)",
+           "p99.9(ns)");
+
+    for (size_t v = 0U;
+         v < (sizeof(bench_variants) / sizeof(bench_variants[0])); v++)
+    {
+        const bench_variant_t *variant = &bench_variants[v];
+
+        for (size_t e = 0U;
+             e < (sizeof(bench_element_sizes) / sizeof(bench_element_sizes[0]));
+             e++)
+        {
+            for (size_t c = 0U;
+                 c < (sizeof(bench_capacities) / sizeof(bench_capacities[0]));
+                 c++)
+            {
+                bench_sweep(variant, ctx, bench_element_sizes[e],
+                            bench_capacities[c], cpus);
+            }
+        }
+    }
+
+    for (size_t v = 0U;
+         v < (sizeof(bench_stream_variants) / sizeof(bench_stream_variants[0]));
+         v++)
+    {
+        bench_sweep(&bench_stream_variants[v], ctx, BENCH_STREAM_ELEMENT_SIZE,
+                    BENCH_STREAM_CAPACITY, cpus);
+    }
+
+    (void)pthread_mutex_destroy(&ctx->mutex);
+    free(ctx->storage);
+    free(ctx->latencies);
+
+    return 0;
+}
@@ -115,7 +115,10 @@ void *dequeue_thread(void *args)
         else if (status == RING_BUFFER_EMPTY)
         {
             /* Check if all elements have been enqueued and dequeued */
-            if (ring->head == ring->tail)
+            ring_buffer_index_t size = 0U;
+
+            if ((ring_buffer_size(ring, &size) == RING_BUFFER_OK) &&
+                (size == 0U))
             {
                 pthread_mutex_unlock(mutex);
                 break; /* Exit the loop if all elements have been processed */
@@ -13,26 +13,81 @@
  ******************************************************************************/
 
 #include "ring_buffer.h"
+#include "ring_buffer_internal.h"
+#include "ring_buffer_inline.h"
+#include "ring_buffer_alloc.h"
+#include "ring_buffer_copy.h"
 #include <string.h>
 #include <stdint.h>
 
-/* Inline function to calculate the next index in the ring buffer */
-static inline uint32_t ring_buffer_next_index(uint32_t index, uint32_t lenght)
+/* Inline function to check whether a length is a power of two */
+static inline int ring_buffer_is_pow2(ring_buffer_index_t length)
 {
-	return  (index + 1U) % lenght ;
+    return (length != 0U) && ((length & (length - 1U)) == 0U);
+}
 
+/* Inline function to map a head or tail value onto its slot */
+static inline ring_buffer_index_t ring_buffer_slot(const ring_buffer_t *handle,
+                                        ring_buffer_index_t index)
+{
+    return (handle->mask != 0U) ? (index & handle->mask) : index;
 }
 
-/* Inline Function to calculate the previous index in the ring buffer */
-static inline uint32_t ring_buffer_prev_index(uint32_t index, uint32_t lenght)
+/* Inline function to get the number of slots addressable without wrapping */
+static inline ring_buffer_index_t ring_buffer_span(const ring_buffer_t *handle)
 {
-	return (index == 0U) ? (lenght - 1U) : (index - 1U);
+    return (handle->is_mirrored != 0U) ? (2U * handle->length)
+                                       : handle->length;
 }
 
+/* Inline function to advance the head after n elements were written */
+static inline void ring_buffer_advance_head(ring_buffer_t *handle,
+                                            ring_buffer_index_t n)
+{
+    if (handle->mask != 0U)
+    {
+        handle->head += n;
+        return;
+    }
+
+    /* Wrap without forming head + n, which may not fit the index type */
+    handle->head = (n >= (handle->length - handle->head))
+                       ? (n - (handle->length - handle->head))
+                       : (handle->head + n);
+
+    if (n != 0U)
+    {
+        handle->is_empty = 0U;
+        handle->is_full = (handle->head == handle->tail) ? 1U : 0U;
+    }
+}
+
+/* Inline function to advance the tail after n elements were read */
+static inline void ring_buffer_advance_tail(ring_buffer_t *handle,
+                                            ring_buffer_index_t n)
+{
+    if (handle->mask != 0U)
+    {
+        handle->tail += n;
+        return;
+    }
+
+    /* Wrap without forming tail + n, which may not fit the index type */
+    handle->tail = (n >= (handle->length - handle->tail))
+                       ? (n - (handle->length - handle->tail))
+                       : (handle->tail + n);
+
+    if (n != 0U)
+    {
+        handle->is_full = 0U;
+        handle->is_empty = (handle->head == handle->tail) ? 1U : 0U;
+    }
+}
 
 /* Initialize the ring buffer */
 ring_buffer_status_t ring_buffer_init(ring_buffer_t *handle,
-                                      size_t element_size, uint32_t length,
+                                      size_t element_size,
+                                      ring_buffer_index_t length,
                                       uint8_t *buffer)
 {
     if ((handle == NULL) || (buffer == NULL))
@@ -45,7 +100,8 @@ ring_buffer_status_t ring_buffer_init(ring_buffer_t *handle,
         return RING_BUFFER_ALREADY_INITIALIZED;
     }
 
-    if ((element_size == 0U) || (length < 2U))
+    if ((element_size == 0U) || (length < 2U) ||
+        (length > RING_BUFFER_INDEX_LENGTH_MAX))
     {
         return RING_BUFFER_INVALID_PARAMS;
     }
@@ -56,6 +112,7 @@ ring_buffer_status_t ring_buffer_init(ring_buffer_t *handle,
     handle->element_size = element_size;
     handle->length = length;
     handle->buffer = buffer;
+    (void)ring_buffer_copy_select(element_size, length, &handle->stream_in);
 
     handle->is_dynamic = 0U;
     handle->is_empty = 1U;
@@ -64,6 +121,129 @@ ring_buffer_status_t ring_buffer_init(ring_buffer_t *handle,
     return RING_BUFFER_OK;
 }
 
+/* Initialize the ring buffer in power-of-two mode */
+ring_buffer_status_t ring_buffer_init_pow2(ring_buffer_t *handle,
+                                           size_t element_size,
+                                           ring_buffer_index_t length,
+                                           uint8_t *buffer)
+{
+    if (!ring_buffer_is_pow2(length))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_init(handle, element_size, length, buffer);
+
+    if (status == RING_BUFFER_OK)
+    {
+        handle->mask = length - 1U;
+    }
+
+    return status;
+}
+
+/* Initialize the ring buffer over a mirrored buffer */
+ring_buffer_status_t ring_buffer_init_mirrored(ring_buffer_t *handle,
+                                               size_t element_size,
+                                               ring_buffer_index_t length,
+                                               uint8_t *buffer)
+{
+    if (length >= RING_BUFFER_INDEX_LENGTH_MAX)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_is_pow2(length)
+            ? ring_buffer_init_pow2(handle, element_size, length, buffer)
+            : ring_buffer_init(handle, element_size, length, buffer);
+
+    if (status == RING_BUFFER_OK)
+    {
+        handle->is_mirrored = 1U;
+    }
+
+    return status;
+}
+
+/* Allocate a buffer and initialize the ring buffer over it */
+ring_buffer_status_t
+ring_buffer_create(ring_buffer_t *handle, size_t element_size,
+                   ring_buffer_index_t length,
+                   const ring_buffer_alloc_options_t *options)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((element_size == 0U) || (length < 2U) ||
+        (element_size > (SIZE_MAX / length)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_block_t block;
+    ring_buffer_status_t status =
+        ring_buffer_block_alloc(&block, element_size * length, options);
+
+    if (status != RING_BUFFER_OK)
+    {
+        return status;
+    }
+
+    if (block.kind == RING_BUFFER_BLOCK_MIRROR)
+    {
+        status = ring_buffer_init_mirrored(handle, element_size, length,
+                                           block.buffer);
+    }
+    else if (ring_buffer_is_pow2(length))
+    {
+        status = ring_buffer_init_pow2(handle, element_size, length,
+                                       block.buffer);
+    }
+    else
+    {
+        status = ring_buffer_init(handle, element_size, length, block.buffer);
+    }
+
+    if (status != RING_BUFFER_OK)
+    {
+        (void)ring_buffer_block_free(&block);
+        return status;
+    }
+
+    handle->is_dynamic = 1U;
+    handle->alloc_kind = block.kind;
+    handle->alloc_size = block.size;
+
+    return RING_BUFFER_OK;
+}
+
+/* Round a length up to the next power of two */
+ring_buffer_index_t ring_buffer_round_up_pow2(ring_buffer_index_t value)
+{
+    if (value > RING_BUFFER_INDEX_LENGTH_MAX)
+    {
+        return 0U;
+    }
+
+    ring_buffer_index_t result = 1U;
+
+    while (result < value)
+    {
+        result <<= 1U;
+    }
+
+    return result;
+}
+
 /* Destroy the ring buffer */
 ring_buffer_status_t ring_buffer_destroy(ring_buffer_t *handle)
 {
@@ -77,7 +257,15 @@ ring_buffer_status_t ring_buffer_destroy(ring_buffer_t *handle)
         return RING_BUFFER_NOT_INITIALIZED;
     }
 
-    /* No dynamic memory allocation, so no need to free buffer */
+    /* Free the buffer if ring_buffer_create() allocated it */
+    if (handle->is_dynamic != 0U)
+    {
+        ring_buffer_block_t block = {handle->buffer, handle->alloc_size,
+                                     handle->alloc_kind};
+
+        (void)ring_buffer_block_free(&block);
+    }
+
     /* Clear the handle structure */
     (void)memset(handle, 0, sizeof(ring_buffer_t));
 
@@ -98,28 +286,43 @@ ring_buffer_status_t ring_buffer_push(ring_buffer_t *handle,
         return RING_BUFFER_NOT_INITIALIZED;
     }
 
-    if (handle->is_full != 0U)
+    return ring_buffer_push_unchecked(handle, element);
+}
+
+/* Push an element, dropping the oldest one if the ring buffer is full */
+ring_buffer_status_t ring_buffer_push_overwrite(ring_buffer_t *handle,
+                                                const void *element,
+                                                ring_buffer_index_t *dropped)
+{
+    if ((handle == NULL) || (element == NULL) || (dropped == NULL))
     {
-        return RING_BUFFER_FULL;
+        return RING_BUFFER_INVALID_PARAMS;
     }
-	
-    /* Calculate the offset for the head position */
-    uint32_t offset = handle->head * handle->element_size;
 
-    /* Copy the element into the buffer at the head position */
-    (void)memcpy(&handle->buffer[offset], element, handle->element_size);
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
 
-	/* Update the head position*/
-	handle->head = ring_buffer_next_index(handle->head, handle->length);
+    *dropped = 0U;
+
+    if (ring_buffer_count(handle) == handle->length)
+    {
+        /* The head slot is the oldest element: give it up to the writer */
+        ring_buffer_advance_tail(handle, 1U);
+        *dropped = 1U;
+        RING_BUFFER_STAT_ADD(handle->producer_stats.overwrites, 1U);
+    }
+
+    size_t offset = (size_t)ring_buffer_slot(handle, handle->head) *
+                    handle->element_size;
+    ring_buffer_store(handle->stream_in, &handle->buffer[offset], element,
+                      handle->element_size);
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                              ring_buffer_slot(handle, handle->head), 1U);
+    ring_buffer_advance_head(handle, 1U);
+    ring_buffer_stats_push(handle, 1U);
 
-	/* Check if buffer is now full */
-	if(handle->head == handle->tail)
-	{
-		handle->is_full = 1U ;
-	}
-   	
-	handle->is_empty = 0U ;
- 
     return RING_BUFFER_OK;
 }
 
@@ -136,27 +339,207 @@ ring_buffer_status_t ring_buffer_pop(ring_buffer_t *handle, void *element)
         return RING_BUFFER_NOT_INITIALIZED;
     }
 
-    if (handle->is_empty != 0U)
+    return ring_buffer_pop_unchecked(handle, element);
+}
+
+/* Push up to count elements into the ring buffer */
+ring_buffer_status_t ring_buffer_push_n(ring_buffer_t *handle,
+                                        const void *elements,
+                                        ring_buffer_index_t count,
+                                        ring_buffer_index_t *pushed)
+{
+    if ((handle == NULL) || (elements == NULL) || (pushed == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t space = handle->length - ring_buffer_count(handle);
+    ring_buffer_index_t n = (count < space) ? count : space;
+
+    *pushed = n;
+
+    if ((n == 0U) && (count != 0U))
+    {
+        RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+        return RING_BUFFER_FULL;
+    }
+
+    ring_buffer_copy_in(handle->stream_in, handle->buffer,
+                        ring_buffer_span(handle),
+                        handle->element_size,
+                        ring_buffer_slot(handle, handle->head),
+                        (const uint8_t *)elements, n);
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                              ring_buffer_slot(handle, handle->head), n);
+    ring_buffer_advance_head(handle, n);
+    ring_buffer_stats_push(handle, n);
+
+    return RING_BUFFER_OK;
+}
+
+/* Pop up to count elements from the ring buffer */
+ring_buffer_status_t ring_buffer_pop_n(ring_buffer_t *handle, void *elements,
+                                       ring_buffer_index_t count,
+                                       ring_buffer_index_t *popped)
+{
+    if ((handle == NULL) || (elements == NULL) || (popped == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
     {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t used = ring_buffer_count(handle);
+    ring_buffer_index_t n = (count < used) ? count : used;
+
+    *popped = n;
+
+    if ((n == 0U) && (count != 0U))
+    {
+        RING_BUFFER_STAT_ADD(handle->consumer_stats.empty_rejects, 1U);
         return RING_BUFFER_EMPTY;
     }
 
-    /* Calculate the offset for the tail position */
-    uint32_t offset = handle->tail * handle->element_size;
+    ring_buffer_copy_out(handle->buffer, ring_buffer_span(handle),
+                         handle->element_size,
+                         ring_buffer_slot(handle, handle->tail),
+                         (uint8_t *)elements, n);
+    RING_BUFFER_LATENCY_RECORD(handle->latency, handle->stamps, handle->length,
+                               ring_buffer_slot(handle, handle->tail), n);
+    ring_buffer_advance_tail(handle, n);
+    RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, n);
+
+    return RING_BUFFER_OK;
+}
+
+/* Reserve contiguous space for up to count elements at the head */
+ring_buffer_status_t ring_buffer_reserve(ring_buffer_t *handle,
+                                         ring_buffer_index_t count, void **ptr,
+                                         ring_buffer_index_t *contig)
+{
+    if ((handle == NULL) || (ptr == NULL) || (contig == NULL) ||
+        (count == 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
 
-    /* Copy the element from the buffer at the tail position */
-    (void)memcpy(element, &handle->buffer[offset], handle->element_size);
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
 
-	/* Update the tail position */
-	handle->tail = ring_buffer_next_index(handle->tail, handle->length);
+    ring_buffer_index_t slot = ring_buffer_slot(handle, handle->head);
+    ring_buffer_index_t space = handle->length - ring_buffer_count(handle);
+    ring_buffer_index_t n = ring_buffer_span(handle) - slot;
 
-	/* Check if buffer is now empty */
-	if (handle->head == handle->tail)	
-	{
-		handle->is_empty = 1U ;
-	}
+    n = (n < space) ? n : space;
+    n = (n < count) ? n : count;
 
-	handle->is_full = 0U ;
+    *ptr = &handle->buffer[(size_t)slot * handle->element_size];
+    *contig = n;
+
+    if (n == 0U)
+    {
+        RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+        return RING_BUFFER_FULL;
+    }
+
+    return RING_BUFFER_OK;
+}
+
+/* Make count reserved elements available to the consumer */
+ring_buffer_status_t ring_buffer_commit(ring_buffer_t *handle,
+                                        ring_buffer_index_t count)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (count > (handle->length - ring_buffer_count(handle)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                              ring_buffer_slot(handle, handle->head), count);
+    ring_buffer_advance_head(handle, count);
+    ring_buffer_stats_push(handle, count);
+
+    return RING_BUFFER_OK;
+}
+
+/* Get a pointer to up to count contiguous elements at the tail */
+ring_buffer_status_t ring_buffer_peek(ring_buffer_t *handle,
+                                      ring_buffer_index_t count, void **ptr,
+                                      ring_buffer_index_t *contig)
+{
+    if ((handle == NULL) || (ptr == NULL) || (contig == NULL) ||
+        (count == 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t slot = ring_buffer_slot(handle, handle->tail);
+    ring_buffer_index_t used = ring_buffer_count(handle);
+    ring_buffer_index_t n = ring_buffer_span(handle) - slot;
+
+    n = (n < used) ? n : used;
+    n = (n < count) ? n : count;
+
+    *ptr = &handle->buffer[(size_t)slot * handle->element_size];
+    *contig = n;
+
+    if (n == 0U)
+    {
+        RING_BUFFER_STAT_ADD(handle->consumer_stats.empty_rejects, 1U);
+        return RING_BUFFER_EMPTY;
+    }
+
+    return RING_BUFFER_OK;
+}
+
+/* Give count peeked elements back to the producer */
+ring_buffer_status_t ring_buffer_release(ring_buffer_t *handle,
+                                         ring_buffer_index_t count)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (count > ring_buffer_count(handle))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    RING_BUFFER_LATENCY_RECORD(handle->latency, handle->stamps, handle->length,
+                               ring_buffer_slot(handle, handle->tail), count);
+    ring_buffer_advance_tail(handle, count);
+    RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, count);
 
     return RING_BUFFER_OK;
 }
@@ -174,6 +557,23 @@ ring_buffer_status_t ring_buffer_state(const ring_buffer_t *handle)
         return RING_BUFFER_NOT_INITIALIZED;
     }
 
+    if (handle->mask != 0U)
+    {
+        ring_buffer_index_t count =
+            (ring_buffer_index_t)(handle->head - handle->tail);
+
+        if (count == 0U)
+        {
+            return RING_BUFFER_EMPTY;
+        }
+        else if (count == handle->length)
+        {
+            return RING_BUFFER_FULL;
+        }
+
+        return RING_BUFFER_OK;
+    }
+
     if (handle->is_empty != 0U)
     {
         return RING_BUFFER_EMPTY;
@@ -186,6 +586,120 @@ ring_buffer_status_t ring_buffer_state(const ring_buffer_t *handle)
     return RING_BUFFER_OK;
 }
 
+/* Get the number of elements in the ring buffer */
+ring_buffer_status_t ring_buffer_size(const ring_buffer_t *handle,
+                                      ring_buffer_index_t *size)
+{
+    if ((handle == NULL) || (size == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *size = ring_buffer_count(handle);
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the number of elements the ring buffer can hold */
+ring_buffer_status_t ring_buffer_capacity(const ring_buffer_t *handle,
+                                          ring_buffer_index_t *capacity)
+{
+    if ((handle == NULL) || (capacity == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *capacity = handle->length;
+
+    return RING_BUFFER_OK;
+}
+
+/* Take a snapshot of the ring buffer counters */
+ring_buffer_status_t ring_buffer_stats(const ring_buffer_t *handle,
+                                       ring_buffer_stats_t *stats)
+{
+    if ((handle == NULL) || (stats == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_stats_read(&handle->producer_stats, &handle->consumer_stats,
+                           stats);
+
+    return RING_BUFFER_OK;
+#else
+    (void)memset(stats, 0, sizeof(ring_buffer_stats_t));
+
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Start timestamping elements to measure how long they are queued */
+ring_buffer_status_t ring_buffer_set_latency_stamps(ring_buffer_t *handle,
+                                                    uint64_t *stamps)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef RING_BUFFER_ENABLE_LATENCY
+    handle->stamps = stamps;
+
+    return RING_BUFFER_OK;
+#else
+    (void)stamps;
+
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Take a snapshot of the dwell-time histogram */
+ring_buffer_status_t ring_buffer_latency(const ring_buffer_t *handle,
+                                         ring_buffer_latency_t *latency)
+{
+    if ((handle == NULL) || (latency == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef RING_BUFFER_ENABLE_LATENCY
+    ring_buffer_latency_read(&handle->latency, latency);
+
+    return RING_BUFFER_OK;
+#else
+    (void)memset(latency, 0, sizeof(ring_buffer_latency_t));
+
+    return RING_BUFFER_FAIL;
+#endif
+}
+
 /* Clear the ring buffer */
 ring_buffer_status_t ring_buffer_clear(ring_buffer_t *handle)
 {
@@ -199,9 +713,6 @@ ring_buffer_status_t ring_buffer_clear(ring_buffer_t *handle)
         return RING_BUFFER_NOT_INITIALIZED;
     }
 
-    /* Clear the buffer memory */
-    (void)memset(handle->buffer, 0, handle->length * handle->element_size);
-
     /* Reset the state flags and indices */
     handle->head = 0U;
     handle->tail = 0U;
@@ -210,3 +721,17 @@ ring_buffer_status_t ring_buffer_clear(ring_buffer_t *handle)
 
     return RING_BUFFER_OK;
 }
+
+/* Clear the ring buffer and wipe its memory */
+ring_buffer_status_t ring_buffer_clear_secure(ring_buffer_t *handle)
+{
+    ring_buffer_status_t status = ring_buffer_clear(handle);
+
+    if (status == RING_BUFFER_OK)
+    {
+        ring_buffer_secure_wipe(handle->buffer,
+                                (size_t)handle->length * handle->element_size);
+    }
+
+    return status;
+}
@@ -18,9 +18,64 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#if defined(RING_BUFFER_ENABLE_STATS) || defined(RING_BUFFER_ENABLE_LATENCY)
+#include <stdatomic.h>
+#endif
+
 /* Initialization mask to check if the ring buffer has been initialized */
 #define RING_BUFFER_INITIALIZE_MASK 0x5DU
 
+/* Cache line size used to keep producer and consumer state apart */
+#ifndef RING_BUFFER_CACHE_LINE_SIZE
+#define RING_BUFFER_CACHE_LINE_SIZE 64U
+#endif
+
+/*
+ * Size of a slot for size-byte elements padded so that no slot straddles two
+ * cache lines: the next power of two up to 32 bytes, whole cache lines above
+ * it. Use it as the element size, with the element type padded to it, on a
+ * cache-line aligned buffer.
+ */
+#define RING_BUFFER_SLOT_PADDED_SIZE(size)                                     \
+    (((size) > RING_BUFFER_CACHE_LINE_SIZE)                                    \
+         ? (((size_t)(size) + (RING_BUFFER_CACHE_LINE_SIZE - 1U)) &            \
+            ~((size_t)RING_BUFFER_CACHE_LINE_SIZE - 1U))                       \
+     : ((size) <= 1U)   ? (size_t)1U                                           \
+     : ((size) <= 2U)   ? (size_t)2U                                           \
+     : ((size) <= 4U)   ? (size_t)4U                                           \
+     : ((size) <= 8U)   ? (size_t)8U                                           \
+     : ((size) <= 16U)  ? (size_t)16U                                          \
+     : ((size) <= 32U)  ? (size_t)32U                                          \
+                        : (size_t)RING_BUFFER_CACHE_LINE_SIZE)
+
+/*
+ * Width in bits of the element indices and counts (16, 32 or 64). 16 keeps
+ * handles small on microcontrollers, 64 allows more than 2^31 elements.
+ * The whole build must use the same setting.
+ */
+#ifndef RING_BUFFER_INDEX_BITS
+#define RING_BUFFER_INDEX_BITS 32
+#endif
+
+#if RING_BUFFER_INDEX_BITS == 16
+typedef uint16_t ring_buffer_index_t;
+#define RING_BUFFER_INDEX_MAX UINT16_MAX
+#elif RING_BUFFER_INDEX_BITS == 32
+typedef uint32_t ring_buffer_index_t;
+#define RING_BUFFER_INDEX_MAX UINT32_MAX
+#elif RING_BUFFER_INDEX_BITS == 64
+typedef uint64_t ring_buffer_index_t;
+#define RING_BUFFER_INDEX_MAX UINT64_MAX
+#else
+#error "RING_BUFFER_INDEX_BITS must be 16, 32 or 64"
+#endif
+
+/*
+ * Largest length of a ring whose indices run over [0, 2 * length) or are
+ * free-running, so that full and empty stay distinguishable
+ */
+#define RING_BUFFER_INDEX_LENGTH_MAX ((RING_BUFFER_INDEX_MAX / 2U) + 1U)
+
 /* Enumeration for ring buffer status codes */
 typedef enum
 {
@@ -34,19 +89,118 @@ typedef enum
     RING_BUFFER_UNKNOWN_ERROR = 0xFFU
 } ring_buffer_status_t;
 
+/* Allocation flags for ring_buffer_create() (see ring_buffer_alloc.h) */
+#define RING_BUFFER_ALLOC_PAGE_ALIGNED 0x01U /* Page-aligned mapping */
+#define RING_BUFFER_ALLOC_HUGETLB 0x02U      /* MAP_HUGETLB, THP fallback */
+#define RING_BUFFER_ALLOC_THP 0x04U          /* Transparent huge pages */
+#define RING_BUFFER_ALLOC_MIRRORED 0x08U     /* Map the buffer twice */
+
+/* NUMA node value meaning "do not bind" */
+#define RING_BUFFER_ALLOC_ANY_NODE (-1)
+
+/* Options controlling how ring_buffer_create() allocates the buffer */
+typedef struct
+{
+    uint32_t flags;    /* Combination of RING_BUFFER_ALLOC_* flags */
+    int32_t numa_node; /* Node to bind the pages to, or ANY_NODE */
+} ring_buffer_alloc_options_t;
+
+/* Snapshot of the counters kept when RING_BUFFER_ENABLE_STATS is defined */
+typedef struct
+{
+    uint64_t pushes;        /* Elements pushed */
+    uint64_t pops;          /* Elements popped */
+    uint64_t full_rejects;  /* Push calls refused because of a full ring */
+    uint64_t empty_rejects; /* Pop calls refused because of an empty ring */
+    uint64_t overwrites;    /* Elements dropped by overwrite pushes */
+    ring_buffer_index_t high_watermark; /* Highest occupancy seen by the
+                                           producer */
+} ring_buffer_stats_t;
+
+#ifdef RING_BUFFER_ENABLE_STATS
+/*
+ * Counters written by the producer side only. They are relaxed atomics so
+ * that ring_buffer_*_stats() can read them from any thread.
+ */
+typedef struct
+{
+    _Atomic uint64_t pushes;
+    _Atomic uint64_t full_rejects;
+    _Atomic uint64_t overwrites;
+    _Atomic ring_buffer_index_t high_watermark;
+} ring_buffer_producer_stats_t;
+
+/* Counters written by the consumer side only */
+typedef struct
+{
+    _Atomic uint64_t pops;
+    _Atomic uint64_t empty_rejects;
+} ring_buffer_consumer_stats_t;
+#endif
+
+/* Number of buckets in a dwell-time histogram */
+#define RING_BUFFER_LATENCY_BUCKETS 64U
+
+/*
+ * Snapshot of the dwell-time histogram kept when RING_BUFFER_ENABLE_LATENCY
+ * is defined. Times are in ticks of RING_BUFFER_LATENCY_CLOCK(): the TSC on
+ * x86, the virtual counter on AArch64 and nanoseconds elsewhere; define the
+ * macro to a function returning uint64_t to use another clock. Bucket 0
+ * counts dwell times of 0 ticks and bucket i those in [2^(i-1), 2^i), the
+ * last bucket also taking everything longer.
+ */
+typedef struct
+{
+    uint64_t buckets[RING_BUFFER_LATENCY_BUCKETS]; /* Elements per bucket */
+    uint64_t count; /* Elements recorded (sum of the buckets) */
+    uint64_t total; /* Sum of the dwell times */
+    uint64_t max;   /* Longest dwell time */
+} ring_buffer_latency_t;
+
+#ifdef RING_BUFFER_ENABLE_LATENCY
+/*
+ * Histogram written by the consumer side only. Relaxed atomics, like the
+ * statistics counters, so that it can be read from any thread.
+ */
+typedef struct
+{
+    _Atomic uint64_t buckets[RING_BUFFER_LATENCY_BUCKETS];
+    _Atomic uint64_t total;
+    _Atomic uint64_t max;
+} ring_buffer_latency_histogram_t;
+#endif
+
+/* Copy kernel used to push large elements with non-temporal stores */
+typedef void *(*ring_buffer_copy_fn_t)(void *dst, const void *src,
+                                       size_t size);
+
 /* Structure representing the ring buffer */
 typedef struct
 {
     uint8_t *buffer;        /* Pointer to the buffer memory */
-    uint32_t length;        /* Number of elements in the buffer */
+    ring_buffer_index_t length; /* Number of elements in the buffer */
+    ring_buffer_index_t mask; /* length - 1 in power-of-two mode, else 0 */
     size_t element_size;    /* Size of each element in bytes */
-    uint32_t head;          /* Index of the head (next write position) */
-    uint32_t tail;          /* Index of the tail (next read position) */
+    ring_buffer_index_t head; /* Index of the head (next write position) */
+    ring_buffer_index_t tail; /* Index of the tail (next read position) */
     uint8_t init_flag;      /* Initialization flag */
     uint8_t is_full : 1;    /* Flag indicating if the buffer is full */
     uint8_t is_empty : 1;   /* Flag indicating if the buffer is empty */
     uint8_t is_dynamic : 1; /* Flag indicating if buffer was dynamically
                                allocated */
+    uint8_t is_mirrored : 1; /* Flag indicating if buffer is mapped twice
+                                back-to-back */
+    uint8_t alloc_kind;     /* How a dynamic buffer was obtained */
+    size_t alloc_size;      /* Size of a dynamic buffer in bytes */
+    ring_buffer_copy_fn_t stream_in; /* Streaming push copy, or NULL */
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_producer_stats_t producer_stats; /* Push-side counters */
+    ring_buffer_consumer_stats_t consumer_stats; /* Pop-side counters */
+#endif
+#ifdef RING_BUFFER_ENABLE_LATENCY
+    uint64_t *stamps; /* Push time of each slot, or NULL */
+    ring_buffer_latency_histogram_t latency; /* Dwell-time histogram */
+#endif
 } ring_buffer_t;
 
 /* Function prototypes */
@@ -56,17 +210,95 @@ typedef struct
  *
  * @param handle        Pointer to the ring buffer handle.
  * @param element_size  Size of each element in bytes.
- * @param length        Number of elements in the buffer.
+ * @param length        Number of elements in the buffer (at most
+ *                      RING_BUFFER_INDEX_LENGTH_MAX).
  * @param buffer        Pointer to the buffer memory (must not be NULL).
  * @return ring_buffer_status_t Status code.
  */
 ring_buffer_status_t ring_buffer_init(ring_buffer_t *handle,
-                                      size_t element_size, uint32_t length,
+                                      size_t element_size,
+                                      ring_buffer_index_t length,
                                       uint8_t *buffer);
 
+/**
+ * @brief Initialize the ring buffer in power-of-two mode.
+ *
+ * Slots are located by masking instead of a modulo, and head/tail become
+ * free-running counters whose difference is the occupancy, so push and pop
+ * never divide or update the full/empty flags.
+ *
+ * @param handle        Pointer to the ring buffer handle.
+ * @param element_size  Size of each element in bytes.
+ * @param length        Number of elements in the buffer (power of two, at
+ *                      most RING_BUFFER_INDEX_LENGTH_MAX).
+ * @param buffer        Pointer to the buffer memory (must not be NULL).
+ * @return ring_buffer_status_t Status code (RING_BUFFER_INVALID_PARAMS if
+ * length is not a power of two).
+ */
+ring_buffer_status_t ring_buffer_init_pow2(ring_buffer_t *handle,
+                                           size_t element_size,
+                                           ring_buffer_index_t length,
+                                           uint8_t *buffer);
+
+/**
+ * @brief Initialize the ring buffer over a mirrored buffer.
+ *
+ * buffer must map length * element_size bytes twice back-to-back (see
+ * ring_buffer_mirror.h). Bulk, reserve and peek operations then always see
+ * the whole free or used span as contiguous. Power-of-two lengths use the
+ * ring_buffer_init_pow2() index scheme.
+ *
+ * @param handle        Pointer to the ring buffer handle.
+ * @param element_size  Size of each element in bytes.
+ * @param length        Number of elements in the buffer (below
+ *                      RING_BUFFER_INDEX_LENGTH_MAX).
+ * @param buffer        Pointer to the first half of the mirrored mapping.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_init_mirrored(ring_buffer_t *handle,
+                                               size_t element_size,
+                                               ring_buffer_index_t length,
+                                               uint8_t *buffer);
+
+/**
+ * @brief Allocate a buffer and initialize the ring buffer over it.
+ *
+ * With no flags the buffer comes from the heap, aligned to
+ * RING_BUFFER_CACHE_LINE_SIZE. Page alignment, huge pages and NUMA binding
+ * use an anonymous mapping (Linux only); NUMA binding is applied before the
+ * pages are first touched. RING_BUFFER_ALLOC_MIRRORED sets the ring up as
+ * ring_buffer_init_mirrored() does and needs length * element_size to be a
+ * multiple of ring_buffer_mirror_granularity(). Power-of-two lengths use the
+ * ring_buffer_init_pow2() index scheme. ring_buffer_destroy() frees the
+ * buffer.
+ *
+ * @param handle        Pointer to the ring buffer handle.
+ * @param element_size  Size of each element in bytes.
+ * @param length        Number of elements in the buffer.
+ * @param options       Allocation options, or NULL for the defaults.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the memory
+ * could not be allocated or bound).
+ */
+ring_buffer_status_t
+ring_buffer_create(ring_buffer_t *handle, size_t element_size,
+                   ring_buffer_index_t length,
+                   const ring_buffer_alloc_options_t *options);
+
+/**
+ * @brief Round a length up to the next power of two.
+ *
+ * Helper for sizing buffers passed to ring_buffer_init_pow2().
+ *
+ * @param value Requested number of elements.
+ * @return ring_buffer_index_t Smallest power of two >= value, or 0 on overflow.
+ */
+ring_buffer_index_t ring_buffer_round_up_pow2(ring_buffer_index_t value);
+
 /**
  * @brief Destroy the ring buffer.
  *
+ * Frees the buffer if it was allocated by ring_buffer_create().
+ *
  * @param handle Pointer to the ring buffer handle.
  * @return ring_buffer_status_t Status code.
  */
@@ -82,6 +314,22 @@ ring_buffer_status_t ring_buffer_destroy(ring_buffer_t *handle);
 ring_buffer_status_t ring_buffer_push(ring_buffer_t *handle,
                                       const void *element);
 
+/**
+ * @brief Push an element, dropping the oldest one if the ring is full.
+ *
+ * Lossy push for data where fresh samples matter more than complete ones:
+ * when the buffer is full the tail is advanced over the oldest element in
+ * the same call, so the push never fails with RING_BUFFER_FULL.
+ *
+ * @param handle  Pointer to the ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @param dropped Pointer where the number of dropped elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_push_overwrite(ring_buffer_t *handle,
+                                                const void *element,
+                                                ring_buffer_index_t *dropped);
+
 /**
  * @brief Pop an element from the ring buffer.
  *
@@ -91,6 +339,95 @@ ring_buffer_status_t ring_buffer_push(ring_buffer_t *handle,
  */
 ring_buffer_status_t ring_buffer_pop(ring_buffer_t *handle, void *element);
 
+/**
+ * @brief Push up to count elements into the ring buffer.
+ *
+ * Elements are copied with at most two memcpy calls, one on each side of
+ * the wraparound point.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param elements Pointer to count contiguous elements to be pushed.
+ * @param count    Number of elements available at elements.
+ * @param pushed   Pointer where the number of elements pushed is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if no element
+ * could be pushed).
+ */
+ring_buffer_status_t ring_buffer_push_n(ring_buffer_t *handle,
+                                        const void *elements,
+                                        ring_buffer_index_t count,
+                                        ring_buffer_index_t *pushed);
+
+/**
+ * @brief Pop up to count elements from the ring buffer.
+ *
+ * Elements are copied with at most two memcpy calls, one on each side of
+ * the wraparound point.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param elements Pointer where up to count elements will be stored.
+ * @param count    Maximum number of elements to pop.
+ * @param popped   Pointer where the number of elements popped is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if no element
+ * could be popped).
+ */
+ring_buffer_status_t ring_buffer_pop_n(ring_buffer_t *handle, void *elements,
+                                       ring_buffer_index_t count,
+                                       ring_buffer_index_t *popped);
+
+/**
+ * @brief Reserve space at the head for zero-copy writes.
+ *
+ * Returns a pointer straight into the buffer memory and the number of
+ * contiguous free elements behind it (never more than count). The caller
+ * fills them in place and then calls ring_buffer_commit().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param count  Number of elements wanted.
+ * @param ptr    Pointer where the address of the first free slot is stored.
+ * @param contig Pointer where the number of usable elements is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if no space).
+ */
+ring_buffer_status_t ring_buffer_reserve(ring_buffer_t *handle,
+                                         ring_buffer_index_t count, void **ptr,
+                                         ring_buffer_index_t *contig);
+
+/**
+ * @brief Publish elements written through ring_buffer_reserve().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param count  Number of elements written (at most the reserved amount).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_commit(ring_buffer_t *handle,
+                                        ring_buffer_index_t count);
+
+/**
+ * @brief Access elements at the tail without copying them out.
+ *
+ * Returns a pointer straight into the buffer memory and the number of
+ * contiguous stored elements behind it (never more than count). The caller
+ * reads them in place and then calls ring_buffer_release().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param count  Number of elements wanted.
+ * @param ptr    Pointer where the address of the oldest element is stored.
+ * @param contig Pointer where the number of readable elements is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if none).
+ */
+ring_buffer_status_t ring_buffer_peek(ring_buffer_t *handle,
+                                      ring_buffer_index_t count, void **ptr,
+                                      ring_buffer_index_t *contig);
+
+/**
+ * @brief Drop elements accessed through ring_buffer_peek().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param count  Number of elements consumed (at most the peeked amount).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_release(ring_buffer_t *handle,
+                                         ring_buffer_index_t count);
+
 /**
  * @brief Get the current state of the ring buffer.
  *
@@ -100,12 +437,90 @@ ring_buffer_status_t ring_buffer_pop(ring_buffer_t *handle, void *element);
  */
 ring_buffer_status_t ring_buffer_state(const ring_buffer_t *handle);
 
+/**
+ * @brief Get the number of elements in the ring buffer.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param size   Pointer where the number of elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_size(const ring_buffer_t *handle,
+                                      ring_buffer_index_t *size);
+
+/**
+ * @brief Get the number of elements the ring buffer can hold.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param capacity Pointer where the capacity is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_capacity(const ring_buffer_t *handle,
+                                          ring_buffer_index_t *capacity);
+
+/**
+ * @brief Take a snapshot of the ring buffer counters.
+ *
+ * The counters are only kept when the library and its users are built
+ * with RING_BUFFER_ENABLE_STATS defined; otherwise *stats is zeroed and
+ * RING_BUFFER_FAIL is returned. Each counter is read atomically but the
+ * snapshot as a whole is not.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param stats  Pointer where the counters are stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_stats(const ring_buffer_t *handle,
+                                       ring_buffer_stats_t *stats);
+
+/**
+ * @brief Start timestamping elements to measure how long they are queued.
+ *
+ * Only available when the library and its users are built with
+ * RING_BUFFER_ENABLE_LATENCY defined; otherwise RING_BUFFER_FAIL is
+ * returned. Every push then stores the time in the slot's entry of stamps
+ * and every pop adds the time since into the histogram read with
+ * ring_buffer_latency(). Call it while the ring is empty; NULL stops the
+ * measurement.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param stamps Pointer to one uint64_t per element of the buffer, or NULL.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_set_latency_stamps(ring_buffer_t *handle,
+                                                    uint64_t *stamps);
+
+/**
+ * @brief Take a snapshot of the dwell-time histogram.
+ *
+ * Same contract as ring_buffer_stats(), for RING_BUFFER_ENABLE_LATENCY.
+ *
+ * @param handle  Pointer to the ring buffer handle.
+ * @param latency Pointer where the histogram is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_latency(const ring_buffer_t *handle,
+                                         ring_buffer_latency_t *latency);
+
 /**
  * @brief Clear the ring buffer.
  *
+ * Only the indices and state flags are reset, so the cost does not depend
+ * on the buffer size; the old contents stay in memory until overwritten.
+ *
  * @param handle Pointer to the ring buffer handle.
  * @return ring_buffer_status_t Status code.
  */
 ring_buffer_status_t ring_buffer_clear(ring_buffer_t *handle);
 
+/**
+ * @brief Clear the ring buffer and wipe its memory.
+ *
+ * Like ring_buffer_clear(), but also overwrites the whole buffer with
+ * zeros in a way the compiler cannot elide. This touches every page.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_clear_secure(ring_buffer_t *handle);
+
 #endif /* RING_BUFFER_H_ */
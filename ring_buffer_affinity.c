@@ -0,0 +1,137 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_affinity.c                                               *
+ * Description:                                                               *
+ *     Implementation of the thread pinning and CPU topology helpers.         *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "ring_buffer_affinity.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+/* Longest thread_siblings_list file that is parsed */
+#define RING_BUFFER_AFFINITY_LIST_SIZE 256U
+
+#ifdef __linux__
+/* Find the first CPU other than cpu in a list such as "0,4" or "0-1,8-9" */
+static ring_buffer_status_t ring_buffer_affinity_parse(const char *list,
+                                                       uint32_t cpu,
+                                                       uint32_t *sibling)
+{
+    const char *cursor = list;
+
+    while ((*cursor >= '0') && (*cursor <= '9'))
+    {
+        char *end = NULL;
+        unsigned long first = strtoul(cursor, &end, 10);
+        unsigned long last = first;
+
+        if (*end == '-')
+        {
+            last = strtoul(&end[1], &end, 10);
+        }
+
+        for (unsigned long i = first; (i <= last) && (i < CPU_SETSIZE); i++)
+        {
+            if (i != cpu)
+            {
+                *sibling = (uint32_t)i;
+                return RING_BUFFER_OK;
+            }
+        }
+
+        cursor = (*end == ',') ? &end[1] : end;
+    }
+
+    return RING_BUFFER_FAIL;
+}
+#endif
+
+/* Pin a thread so that it only runs on one CPU */
+ring_buffer_status_t ring_buffer_pin_thread(pthread_t thread, uint32_t cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+
+    if (cpu >= CPU_SETSIZE)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    if (pthread_setaffinity_np(thread, sizeof(set), &set) != 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    return RING_BUFFER_OK;
+#else
+    (void)thread;
+    (void)cpu;
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Pin the calling thread so that it only runs on one CPU */
+ring_buffer_status_t ring_buffer_pin_self(uint32_t cpu)
+{
+    return ring_buffer_pin_thread(pthread_self(), cpu);
+}
+
+/* Find another hardware thread of the same physical core */
+ring_buffer_status_t ring_buffer_cpu_sibling(uint32_t cpu, uint32_t *sibling)
+{
+    if (sibling == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+#ifdef __linux__
+    char path[96];
+    char list[RING_BUFFER_AFFINITY_LIST_SIZE];
+    ring_buffer_status_t status = RING_BUFFER_FAIL;
+
+    if (cpu >= CPU_SETSIZE)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    (void)snprintf(path, sizeof(path),
+                   "/sys/devices/system/cpu/cpu%u/topology/"
+                   "thread_siblings_list",
+                   (unsigned int)cpu);
+
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    if (fgets(list, (int)sizeof(list), file) != NULL)
+    {
+        status = ring_buffer_affinity_parse(list, cpu, sibling);
+    }
+
+    (void)fclose(file);
+
+    return status;
+#else
+    (void)cpu;
+    return RING_BUFFER_FAIL;
+#endif
+}
@@ -0,0 +1,61 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_affinity.h                                               *
+ * Description:                                                               *
+ *     Header file defining helpers to pin producer and consumer threads to   *
+ *     chosen CPUs or to sibling hyperthreads of the same core.               *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_AFFINITY_H_
+#define RING_BUFFER_AFFINITY_H_
+
+#include <stdint.h>
+#include <pthread.h>
+#include "ring_buffer.h"
+
+/* Function prototypes */
+
+/**
+ * @brief Pin a thread so that it only runs on one CPU.
+ *
+ * A pinned busy-polling consumer keeps its cache warm and is not migrated
+ * away from the producer's caches. Only supported on Linux; elsewhere it
+ * returns RING_BUFFER_FAIL.
+ *
+ * @param thread Thread to pin.
+ * @param cpu    Index of the CPU, as numbered by the operating system.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the CPU is
+ * offline or the thread may not be moved).
+ */
+ring_buffer_status_t ring_buffer_pin_thread(pthread_t thread, uint32_t cpu);
+
+/**
+ * @brief Pin the calling thread so that it only runs on one CPU.
+ *
+ * @param cpu Index of the CPU, as numbered by the operating system.
+ * @return ring_buffer_status_t Status code (see ring_buffer_pin_thread()).
+ */
+ring_buffer_status_t ring_buffer_pin_self(uint32_t cpu);
+
+/**
+ * @brief Find another hardware thread of the same physical core.
+ *
+ * Siblings share the L1 and L2 caches, so a producer and a consumer pinned
+ * to them hand elements over without leaving the core, at the cost of
+ * sharing its execution units. Read from the sysfs CPU topology on Linux;
+ * elsewhere it returns RING_BUFFER_FAIL.
+ *
+ * @param cpu     Index of the CPU.
+ * @param sibling Pointer where the index of its first sibling is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the core
+ * has a single hardware thread or its topology cannot be read).
+ */
+ring_buffer_status_t ring_buffer_cpu_sibling(uint32_t cpu, uint32_t *sibling);
+
+#endif /* RING_BUFFER_AFFINITY_H_ */
@@ -0,0 +1,238 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_alloc.c                                                  *
+ * Description:                                                               *
+ *     Implementation of the buffer allocator behind the ring buffer create   *
+ *     functions.                                                             *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "ring_buffer_alloc.h"
+#include "ring_buffer_mirror.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* mbind() policy binding pages to the nodes in the mask (linux/mempolicy.h) */
+#define RING_BUFFER_MPOL_BIND 2
+
+/* Flags that need an anonymous mapping instead of the heap */
+#define RING_BUFFER_ALLOC_MAPPED_FLAGS                                         \
+    (RING_BUFFER_ALLOC_PAGE_ALIGNED | RING_BUFFER_ALLOC_HUGETLB |              \
+     RING_BUFFER_ALLOC_THP)
+
+/* Inline function to round a size up to a multiple of a power of two */
+static inline size_t ring_buffer_block_round(size_t size, size_t align)
+{
+    return (size + (align - 1U)) & ~(align - 1U);
+}
+
+#ifdef __linux__
+/* Bind untouched pages to a NUMA node */
+static ring_buffer_status_t ring_buffer_block_bind(void *addr, size_t size,
+                                                   int32_t node)
+{
+    unsigned long nodemask;
+
+    if (node == RING_BUFFER_ALLOC_ANY_NODE)
+    {
+        return RING_BUFFER_OK;
+    }
+
+    nodemask = 1UL << (unsigned int)node;
+
+    /* The kernel reads maxnode - 1 bits of the mask */
+    if (syscall(SYS_mbind, addr, size, RING_BUFFER_MPOL_BIND, &nodemask,
+                (unsigned long)(sizeof(nodemask) * CHAR_BIT) + 1UL, 0U) != 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    return RING_BUFFER_OK;
+}
+
+/* Map anonymous memory, preferring huge pages when asked to */
+static ring_buffer_status_t ring_buffer_block_map(ring_buffer_block_t *block,
+                                                  size_t size, uint32_t flags)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    uint8_t *buffer = MAP_FAILED;
+    size_t mapped = 0U;
+
+    if (page <= 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    if ((flags & RING_BUFFER_ALLOC_HUGETLB) != 0U)
+    {
+        mapped = ring_buffer_block_round(size, RING_BUFFER_HUGE_PAGE_SIZE);
+        buffer = mmap(NULL, mapped, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+
+    if (buffer == MAP_FAILED)
+    {
+        mapped = ring_buffer_block_round(size, (size_t)page);
+        buffer = mmap(NULL, mapped, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (buffer == MAP_FAILED)
+        {
+            return RING_BUFFER_FAIL;
+        }
+
+        if ((flags & (RING_BUFFER_ALLOC_HUGETLB | RING_BUFFER_ALLOC_THP)) != 0U)
+        {
+            /* Advisory only: the ring works on small pages too */
+            (void)madvise(buffer, mapped, MADV_HUGEPAGE);
+        }
+    }
+
+    block->buffer = buffer;
+    block->size = mapped;
+    block->kind = RING_BUFFER_BLOCK_MMAP;
+
+    return RING_BUFFER_OK;
+}
+#endif
+
+/* Allocate a block of buffer memory */
+ring_buffer_status_t
+ring_buffer_block_alloc(ring_buffer_block_t *block, size_t size,
+                        const ring_buffer_alloc_options_t *options)
+{
+    uint32_t flags = 0U;
+    int32_t node = RING_BUFFER_ALLOC_ANY_NODE;
+
+    if (block == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (options != NULL)
+    {
+        flags = options->flags;
+        node = options->numa_node;
+    }
+
+    if ((size == 0U) || (size > (SIZE_MAX / 2U)) ||
+        ((node != RING_BUFFER_ALLOC_ANY_NODE) &&
+         ((node < 0) || (node >= (int32_t)(sizeof(unsigned long) *
+                                           CHAR_BIT)))) ||
+        (((flags & RING_BUFFER_ALLOC_MIRRORED) != 0U) &&
+         ((flags & (RING_BUFFER_ALLOC_HUGETLB | RING_BUFFER_ALLOC_THP)) !=
+          0U)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    (void)memset(block, 0, sizeof(ring_buffer_block_t));
+
+    if ((flags & RING_BUFFER_ALLOC_MIRRORED) != 0U)
+    {
+        ring_buffer_mirror_t mirror = {0};
+        ring_buffer_status_t status = ring_buffer_mirror_init(&mirror, size);
+
+        if (status != RING_BUFFER_OK)
+        {
+            return status;
+        }
+
+        block->buffer = mirror.buffer;
+        block->size = mirror.size;
+        block->kind = RING_BUFFER_BLOCK_MIRROR;
+    }
+    else if (((flags & RING_BUFFER_ALLOC_MAPPED_FLAGS) != 0U) ||
+             (node != RING_BUFFER_ALLOC_ANY_NODE))
+    {
+#ifdef __linux__
+        ring_buffer_status_t status = ring_buffer_block_map(block, size, flags);
+
+        if (status != RING_BUFFER_OK)
+        {
+            return status;
+        }
+#else
+        return RING_BUFFER_FAIL;
+#endif
+    }
+    else
+    {
+        size_t rounded = ring_buffer_block_round(size,
+                                                 RING_BUFFER_CACHE_LINE_SIZE);
+
+        block->buffer = aligned_alloc(RING_BUFFER_CACHE_LINE_SIZE, rounded);
+
+        if (block->buffer == NULL)
+        {
+            return RING_BUFFER_FAIL;
+        }
+
+        block->size = rounded;
+        block->kind = RING_BUFFER_BLOCK_HEAP;
+    }
+
+#ifdef __linux__
+    if ((block->kind != RING_BUFFER_BLOCK_HEAP) &&
+        (ring_buffer_block_bind(block->buffer, block->size, node) !=
+         RING_BUFFER_OK))
+    {
+        (void)ring_buffer_block_free(block);
+        return RING_BUFFER_FAIL;
+    }
+#endif
+
+    return RING_BUFFER_OK;
+}
+
+/* Release a block obtained from ring_buffer_block_alloc() */
+ring_buffer_status_t ring_buffer_block_free(ring_buffer_block_t *block)
+{
+    if ((block == NULL) || (block->buffer == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    switch (block->kind)
+    {
+    case RING_BUFFER_BLOCK_HEAP:
+        free(block->buffer);
+        break;
+
+    case RING_BUFFER_BLOCK_MMAP:
+#ifdef __linux__
+        (void)munmap(block->buffer, block->size);
+#endif
+        break;
+
+    case RING_BUFFER_BLOCK_MIRROR:
+    {
+        ring_buffer_mirror_t mirror = {block->buffer, block->size,
+                                       RING_BUFFER_INITIALIZE_MASK};
+
+        (void)ring_buffer_mirror_destroy(&mirror);
+        break;
+    }
+
+    default:
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    (void)memset(block, 0, sizeof(ring_buffer_block_t));
+
+    return RING_BUFFER_OK;
+}
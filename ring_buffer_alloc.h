@@ -0,0 +1,72 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_alloc.h                                                  *
+ * Description:                                                               *
+ *     Header file defining the buffer allocator behind the ring buffer       *
+ *     create functions (alignment, huge pages and NUMA placement).           *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_ALLOC_H_
+#define RING_BUFFER_ALLOC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ring_buffer.h"
+
+/* Size of the huge pages requested with RING_BUFFER_ALLOC_HUGETLB */
+#ifndef RING_BUFFER_HUGE_PAGE_SIZE
+#define RING_BUFFER_HUGE_PAGE_SIZE (2U * 1024U * 1024U)
+#endif
+
+/* Enumeration for the ways a block can be obtained */
+typedef enum
+{
+    RING_BUFFER_BLOCK_HEAP,   /* aligned_alloc(), released with free() */
+    RING_BUFFER_BLOCK_MMAP,   /* Anonymous mapping, released with munmap() */
+    RING_BUFFER_BLOCK_MIRROR  /* Mirrored mapping (ring_buffer_mirror.h) */
+} ring_buffer_block_kind_t;
+
+/* Structure describing an allocated block of buffer memory */
+typedef struct
+{
+    uint8_t *buffer; /* Start of the block */
+    size_t size;     /* Usable size in bytes (one copy if mirrored) */
+    uint8_t kind;    /* ring_buffer_block_kind_t */
+} ring_buffer_block_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Allocate a block of buffer memory.
+ *
+ * Heap blocks are aligned to RING_BUFFER_CACHE_LINE_SIZE. Page alignment,
+ * huge pages and NUMA binding need an anonymous mapping and are only
+ * available on Linux. RING_BUFFER_ALLOC_HUGETLB falls back to transparent
+ * huge pages when no huge pages are reserved. RING_BUFFER_ALLOC_MIRRORED
+ * cannot be combined with the huge page flags.
+ *
+ * @param block   Pointer where the block is described.
+ * @param size    Number of bytes needed.
+ * @param options Allocation options, or NULL for the defaults.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the memory
+ * could not be allocated or bound).
+ */
+ring_buffer_status_t
+ring_buffer_block_alloc(ring_buffer_block_t *block, size_t size,
+                        const ring_buffer_alloc_options_t *options);
+
+/**
+ * @brief Release a block obtained from ring_buffer_block_alloc().
+ *
+ * @param block Pointer to the block description.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_block_free(ring_buffer_block_t *block);
+
+#endif /* RING_BUFFER_ALLOC_H_ */
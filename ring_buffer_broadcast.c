@@ -0,0 +1,347 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_broadcast.c                                              *
+ * Description:                                                               *
+ *     Implementation of the broadcast (single producer, many independent     *
+ *     consumers) ring buffer functions.                                      *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "ring_buffer_broadcast.h"
+#include <string.h>
+#include <stdint.h>
+
+/* Inline function to get the storage of the element at a position */
+static inline uint8_t *
+ring_buffer_broadcast_slot(const ring_buffer_broadcast_t *handle,
+                           ring_buffer_index_t pos)
+{
+    return &handle->buffer[(size_t)(pos & handle->mask) * handle->element_size];
+}
+
+/* Copy an element into a lossy slot with relaxed atomic stores */
+static void ring_buffer_broadcast_store(uint8_t *slot, const uint8_t *element,
+                                        size_t size)
+{
+    size_t i = 0U;
+
+    /* Overrun consumers may read the slot meanwhile; they only race atomics */
+    if (((uintptr_t)slot % sizeof(uintptr_t)) == 0U)
+    {
+        for (; (size - i) >= sizeof(uintptr_t); i += sizeof(uintptr_t))
+        {
+            uintptr_t word;
+
+            (void)memcpy(&word, &element[i], sizeof(word));
+            atomic_store_explicit((_Atomic uintptr_t *)(void *)&slot[i], word,
+                                  memory_order_relaxed);
+        }
+    }
+
+    for (; i < size; i++)
+    {
+        atomic_store_explicit((_Atomic uint8_t *)(void *)&slot[i], element[i],
+                              memory_order_relaxed);
+    }
+}
+
+/* Copy an element out of a lossy slot with relaxed atomic loads */
+static void ring_buffer_broadcast_load(uint8_t *element, const uint8_t *slot,
+                                       size_t size)
+{
+    size_t i = 0U;
+
+    /* Same split as ring_buffer_broadcast_store() for the same slot */
+    if (((uintptr_t)slot % sizeof(uintptr_t)) == 0U)
+    {
+        for (; (size - i) >= sizeof(uintptr_t); i += sizeof(uintptr_t))
+        {
+            uintptr_t word = atomic_load_explicit(
+                (_Atomic uintptr_t *)(void *)&slot[i], memory_order_relaxed);
+
+            (void)memcpy(&element[i], &word, sizeof(word));
+        }
+    }
+
+    for (; i < size; i++)
+    {
+        element[i] = atomic_load_explicit(
+            (_Atomic uint8_t *)(void *)&slot[i], memory_order_relaxed);
+    }
+}
+
+/* Inline function to check whether the last seen slowest cursor blocks head */
+static inline int
+ring_buffer_broadcast_full(const ring_buffer_broadcast_t *handle,
+                           ring_buffer_index_t head)
+{
+    return (ring_buffer_index_t)(head - handle->cached_min) == handle->length;
+}
+
+/* Find the position of the consumer furthest behind the producer */
+static ring_buffer_index_t
+ring_buffer_broadcast_min(ring_buffer_broadcast_t *handle,
+                          ring_buffer_index_t head)
+{
+    ring_buffer_index_t behind = 0U;
+
+    for (uint32_t i = 0U; i < handle->reader_count; i++)
+    {
+        /* Acquire: the consumer has finished copying out what it passed */
+        ring_buffer_index_t pos = atomic_load_explicit(
+            &handle->cursors[i].position, memory_order_acquire);
+
+        if ((ring_buffer_index_t)(head - pos) > behind)
+        {
+            behind = (ring_buffer_index_t)(head - pos);
+        }
+    }
+
+    return (ring_buffer_index_t)(head - behind);
+}
+
+/* Initialize the broadcast ring buffer */
+ring_buffer_status_t
+ring_buffer_broadcast_init(ring_buffer_broadcast_t *handle,
+                           size_t element_size, ring_buffer_index_t length,
+                           uint8_t *buffer,
+                           ring_buffer_broadcast_cursor_t *cursors,
+                           uint32_t reader_count, uint32_t flags)
+{
+    if ((handle == NULL) || (buffer == NULL) || (cursors == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((element_size == 0U) || (length < 2U) ||
+        (length > RING_BUFFER_INDEX_LENGTH_MAX) ||
+        ((length & (length - 1U)) != 0U) || (reader_count == 0U) ||
+        ((flags & ~RING_BUFFER_BROADCAST_LOSSY) != 0U) ||
+        (((uintptr_t)cursors % _Alignof(ring_buffer_broadcast_cursor_t)) !=
+         0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_broadcast_t));
+
+    handle->buffer = buffer;
+    handle->length = length;
+    handle->mask = length - 1U;
+    handle->element_size = element_size;
+    handle->cursors = cursors;
+    handle->reader_count = reader_count;
+    handle->flags = flags;
+
+    for (uint32_t i = 0U; i < reader_count; i++)
+    {
+        atomic_init(&cursors[i].position, 0U);
+        cursors[i].cached_head = 0U;
+    }
+
+    atomic_init(&handle->head, 0U);
+    atomic_init(&handle->claim, 0U);
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+}
+
+/* Destroy the broadcast ring buffer */
+ring_buffer_status_t
+ring_buffer_broadcast_destroy(ring_buffer_broadcast_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_broadcast_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element for every consumer */
+ring_buffer_status_t ring_buffer_broadcast_push(ring_buffer_broadcast_t *handle,
+                                                const void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    /* The producer owns head; the cursors are only rescanned when full */
+    ring_buffer_index_t head =
+        atomic_load_explicit(&handle->head, memory_order_relaxed);
+
+    if ((handle->flags & RING_BUFFER_BROADCAST_LOSSY) != 0U)
+    {
+        /* Announce the overwrite before the slot changes */
+        atomic_store_explicit(&handle->claim, (ring_buffer_index_t)(head + 1U),
+                              memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        ring_buffer_broadcast_store(ring_buffer_broadcast_slot(handle, head),
+                                    (const uint8_t *)element,
+                                    handle->element_size);
+    }
+    else
+    {
+        if (ring_buffer_broadcast_full(handle, head))
+        {
+            handle->cached_min = ring_buffer_broadcast_min(handle, head);
+
+            if (ring_buffer_broadcast_full(handle, head))
+            {
+                return RING_BUFFER_FULL;
+            }
+        }
+
+        (void)memcpy(ring_buffer_broadcast_slot(handle, head), element,
+                     handle->element_size);
+    }
+
+    /* Publish the element to every consumer */
+    atomic_store_explicit(&handle->head, (ring_buffer_index_t)(head + 1U),
+                          memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Pop the next element for one consumer */
+ring_buffer_status_t ring_buffer_broadcast_pop(ring_buffer_broadcast_t *handle,
+                                               uint32_t reader, void *element,
+                                               ring_buffer_index_t *lost)
+{
+    if ((handle == NULL) || (element == NULL) || (lost == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (reader >= handle->reader_count)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_broadcast_cursor_t *cursor = &handle->cursors[reader];
+    ring_buffer_index_t pos =
+        atomic_load_explicit(&cursor->position, memory_order_relaxed);
+
+    *lost = 0U;
+
+    for (;;)
+    {
+        /* The consumer owns its cursor; head is reloaded when it looks empty */
+        if (cursor->cached_head == pos)
+        {
+            cursor->cached_head =
+                atomic_load_explicit(&handle->head, memory_order_acquire);
+
+            if (cursor->cached_head == pos)
+            {
+                if (*lost != 0U)
+                {
+                    atomic_store_explicit(&cursor->position, pos,
+                                          memory_order_release);
+                }
+
+                return RING_BUFFER_EMPTY;
+            }
+        }
+
+        if ((handle->flags & RING_BUFFER_BROADCAST_LOSSY) == 0U)
+        {
+            (void)memcpy(element, ring_buffer_broadcast_slot(handle, pos),
+                         handle->element_size);
+            break;
+        }
+
+        /* Slot pos is overwritten once the producer claims pos + length */
+        ring_buffer_index_t claim =
+            atomic_load_explicit(&handle->claim, memory_order_relaxed);
+
+        if ((ring_buffer_index_t)(claim - pos) <= handle->length)
+        {
+            ring_buffer_broadcast_load((uint8_t *)element,
+                                       ring_buffer_broadcast_slot(handle, pos),
+                                       handle->element_size);
+
+            /* Check that the producer did not start overwriting the copy */
+            atomic_thread_fence(memory_order_acquire);
+            claim = atomic_load_explicit(&handle->claim, memory_order_relaxed);
+
+            if ((ring_buffer_index_t)(claim - pos) <= handle->length)
+            {
+                break;
+            }
+        }
+
+        /* Overrun: skip to the oldest element that is still intact */
+        *lost += (ring_buffer_index_t)(claim - handle->length - pos);
+        pos = (ring_buffer_index_t)(claim - handle->length);
+        cursor->cached_head =
+            atomic_load_explicit(&handle->head, memory_order_acquire);
+    }
+
+    /* Hand the slot back to the producer */
+    atomic_store_explicit(&cursor->position, (ring_buffer_index_t)(pos + 1U),
+                          memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the number of elements one consumer has yet to read */
+ring_buffer_status_t
+ring_buffer_broadcast_size(const ring_buffer_broadcast_t *handle,
+                           uint32_t reader, ring_buffer_index_t *size)
+{
+    if ((handle == NULL) || (size == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (reader >= handle->reader_count)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_index_t pos = atomic_load_explicit(
+        &handle->cursors[reader].position, memory_order_acquire);
+    ring_buffer_index_t head =
+        atomic_load_explicit(&handle->head, memory_order_acquire);
+    ring_buffer_index_t behind = (ring_buffer_index_t)(head - pos);
+
+    *size = (behind > handle->length) ? handle->length : behind;
+
+    return RING_BUFFER_OK;
+}
@@ -0,0 +1,150 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_broadcast.h                                              *
+ * Description:                                                               *
+ *     Header file defining a single-producer ring buffer whose elements are  *
+ *     read by every one of several consumers, each with its own cursor.      *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_BROADCAST_H_
+#define RING_BUFFER_BROADCAST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+
+/* Flags for ring_buffer_broadcast_init() */
+#define RING_BUFFER_BROADCAST_LOSSY 0x01U /* Overwrite unread elements */
+
+/*
+ * Read cursor of one consumer.
+ *
+ * Each cursor sits on its own cache line so that consumers never write to
+ * a line another consumer reads from.
+ */
+typedef struct
+{
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic ring_buffer_index_t position; /* Next position to read */
+    ring_buffer_index_t cached_head;      /* Last seen producer head */
+} ring_buffer_broadcast_cursor_t;
+
+/*
+ * Structure representing the broadcast ring buffer.
+ *
+ * The producer writes each element once and every consumer reads it with
+ * its own cursor (disruptor style). head and the cursors are free-running
+ * counters. By default the producer is held back by the slowest cursor.
+ * In lossy mode it never waits: a consumer that falls more than length
+ * elements behind loses the oldest ones and is told how many it missed.
+ * To detect a slot being overwritten while it is copied out, the lossy
+ * producer announces each write in claim before touching the slot, and
+ * slots are copied in and out with relaxed atomic words so that such a
+ * race is not undefined behaviour.
+ */
+typedef struct
+{
+    uint8_t *buffer;            /* Pointer to the buffer memory */
+    ring_buffer_index_t length; /* Number of elements (power of two) */
+    ring_buffer_index_t mask;   /* length - 1 */
+    size_t element_size;        /* Size of each element in bytes */
+    ring_buffer_broadcast_cursor_t *cursors; /* One cursor per consumer */
+    uint32_t reader_count;      /* Number of cursors */
+    uint32_t flags;             /* Combination of RING_BUFFER_BROADCAST_* */
+    uint8_t init_flag;          /* Initialization flag */
+
+    /* Producer-side block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic ring_buffer_index_t head;  /* Next position to write */
+    _Atomic ring_buffer_index_t claim; /* Lossy: position being written + 1 */
+    ring_buffer_index_t cached_min;    /* Last seen slowest cursor */
+} ring_buffer_broadcast_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Initialize the broadcast ring buffer.
+ *
+ * Every consumer starts at position 0 and sees every element pushed from
+ * then on. Outside lossy mode a consumer that stops reading eventually
+ * stops the producer.
+ *
+ * @param handle       Pointer to the ring buffer handle.
+ * @param element_size Size of each element in bytes.
+ * @param length       Number of elements in the buffer (power of two, at
+ *                     most RING_BUFFER_INDEX_LENGTH_MAX).
+ * @param buffer       Pointer to element_size * length bytes.
+ * @param cursors      Pointer to reader_count cursors.
+ * @param reader_count Number of consumers.
+ * @param flags        Combination of RING_BUFFER_BROADCAST_* flags.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_broadcast_init(ring_buffer_broadcast_t *handle,
+                           size_t element_size, ring_buffer_index_t length,
+                           uint8_t *buffer,
+                           ring_buffer_broadcast_cursor_t *cursors,
+                           uint32_t reader_count, uint32_t flags);
+
+/**
+ * @brief Destroy the broadcast ring buffer.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_broadcast_destroy(ring_buffer_broadcast_t *handle);
+
+/**
+ * @brief Push an element for every consumer.
+ *
+ * Only one thread may push at a time.
+ *
+ * @param handle  Pointer to the ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if the slowest
+ * consumer has not read the oldest element yet; never in lossy mode).
+ */
+ring_buffer_status_t ring_buffer_broadcast_push(ring_buffer_broadcast_t *handle,
+                                                const void *element);
+
+/**
+ * @brief Pop the next element for one consumer.
+ *
+ * Each reader index may only be used by one thread at a time. In lossy
+ * mode a consumer that was overrun skips to the oldest element still in
+ * the buffer.
+ *
+ * @param handle  Pointer to the ring buffer handle.
+ * @param reader  Index of the consumer's cursor.
+ * @param element Pointer where the popped element will be stored.
+ * @param lost    Pointer where the number of elements this consumer missed
+ *                is stored (always 0 outside lossy mode).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_broadcast_pop(ring_buffer_broadcast_t *handle,
+                                               uint32_t reader, void *element,
+                                               ring_buffer_index_t *lost);
+
+/**
+ * @brief Get the number of elements one consumer has yet to read.
+ *
+ * In lossy mode the value is capped at the buffer length.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param reader Index of the consumer's cursor.
+ * @param size   Pointer where the number of elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_broadcast_size(const ring_buffer_broadcast_t *handle,
+                           uint32_t reader, ring_buffer_index_t *size);
+
+#endif /* RING_BUFFER_BROADCAST_H_ */
@@ -0,0 +1,372 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_bytes.c                                                  *
+ * Description:                                                               *
+ *     Implementation of the variable-length record ring buffer functions.    *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "ring_buffer_bytes.h"
+#include <string.h>
+#include <stdint.h>
+
+/* Inline function to get the length field of the header at a position */
+static inline uint32_t *
+ring_buffer_bytes_header(const ring_buffer_bytes_t *handle, uint32_t pos)
+{
+    return (uint32_t *)(void *)&handle->buffer[pos & handle->mask];
+}
+
+/*
+ * Find the oldest record for the consumer, stepping over skip markers.
+ * Returns NULL when the buffer is empty; otherwise *pos is the position of
+ * the record header.
+ */
+static uint32_t *ring_buffer_bytes_front(ring_buffer_bytes_t *handle,
+                                         uint32_t *pos)
+{
+    uint32_t tail = atomic_load_explicit(&handle->tail, memory_order_relaxed);
+
+    for (;;)
+    {
+        if (handle->cached_head == tail)
+        {
+            handle->cached_head =
+                atomic_load_explicit(&handle->head, memory_order_acquire);
+
+            if (handle->cached_head == tail)
+            {
+                return NULL;
+            }
+        }
+
+        uint32_t *header = ring_buffer_bytes_header(handle, tail);
+
+        if (*header != RING_BUFFER_BYTES_SKIP)
+        {
+            *pos = tail;
+            return header;
+        }
+
+        /* Padding up to the end of the buffer: give it back right away */
+        tail += handle->capacity - (tail & handle->mask);
+        atomic_store_explicit(&handle->tail, tail, memory_order_release);
+    }
+}
+
+/* Initialize the record ring buffer */
+ring_buffer_status_t ring_buffer_bytes_init(ring_buffer_bytes_t *handle,
+                                            uint32_t capacity,
+                                            uint8_t *buffer)
+{
+    if ((handle == NULL) || (buffer == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((capacity < (2U * RING_BUFFER_BYTES_HEADER_SIZE)) ||
+        (capacity > 0x80000000U) || ((capacity & (capacity - 1U)) != 0U) ||
+        (((uintptr_t)buffer % RING_BUFFER_BYTES_ALIGN) != 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_bytes_t));
+
+    handle->buffer = buffer;
+    handle->capacity = capacity;
+    handle->mask = capacity - 1U;
+
+    atomic_init(&handle->head, 0U);
+    atomic_init(&handle->tail, 0U);
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+}
+
+/* Destroy the record ring buffer */
+ring_buffer_status_t ring_buffer_bytes_destroy(ring_buffer_bytes_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_bytes_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Reserve space for a record of up to size payload bytes */
+ring_buffer_status_t ring_buffer_bytes_reserve(ring_buffer_bytes_t *handle,
+                                               uint32_t size, void **data)
+{
+    if ((handle == NULL) || (data == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (size > RING_BUFFER_BYTES_MAX_PAYLOAD(handle->capacity))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    uint32_t record = RING_BUFFER_BYTES_RECORD_SIZE(size);
+    uint32_t head = atomic_load_explicit(&handle->head, memory_order_relaxed);
+    uint32_t contig = handle->capacity - (head & handle->mask);
+
+    /* A record that would wrap is moved to the start of the buffer */
+    uint32_t pad = (record > contig) ? contig : 0U;
+
+    if ((pad + record) > (handle->capacity - (head - handle->cached_tail)))
+    {
+        handle->cached_tail =
+            atomic_load_explicit(&handle->tail, memory_order_acquire);
+
+        if ((pad + record) > (handle->capacity - (head - handle->cached_tail)))
+        {
+            return RING_BUFFER_FULL;
+        }
+    }
+
+    if (pad != 0U)
+    {
+        /* Published together with the record by the commit */
+        *ring_buffer_bytes_header(handle, head) = RING_BUFFER_BYTES_SKIP;
+    }
+
+    handle->reserved_pad = pad;
+    handle->reserved_record = record;
+    *data = &handle->buffer[((head + pad) & handle->mask) +
+                            RING_BUFFER_BYTES_HEADER_SIZE];
+
+    return RING_BUFFER_OK;
+}
+
+/* Publish the record written through ring_buffer_bytes_reserve() */
+ring_buffer_status_t ring_buffer_bytes_commit(ring_buffer_bytes_t *handle,
+                                              uint32_t size)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if ((handle->reserved_record == 0U) ||
+        (size > RING_BUFFER_BYTES_MAX_PAYLOAD(handle->capacity)) ||
+        (RING_BUFFER_BYTES_RECORD_SIZE(size) > handle->reserved_record))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    uint32_t head = atomic_load_explicit(&handle->head, memory_order_relaxed) +
+                    handle->reserved_pad;
+    uint32_t *header = ring_buffer_bytes_header(handle, head);
+
+    header[0] = size;
+    header[1] = 0U;
+
+    handle->reserved_record = 0U;
+
+    /* Publish the skip marker, the header and the payload at once */
+    atomic_store_explicit(&handle->head,
+                          head + RING_BUFFER_BYTES_RECORD_SIZE(size),
+                          memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Push a record into the ring buffer */
+ring_buffer_status_t ring_buffer_bytes_push(ring_buffer_bytes_t *handle,
+                                            const void *data, uint32_t size)
+{
+    void *slot;
+
+    if ((data == NULL) && (size != 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_bytes_reserve(handle, size, &slot);
+
+    if (status != RING_BUFFER_OK)
+    {
+        return status;
+    }
+
+    if (size != 0U)
+    {
+        (void)memcpy(slot, data, size);
+    }
+
+    return ring_buffer_bytes_commit(handle, size);
+}
+
+/* Access the oldest record without copying it out */
+ring_buffer_status_t ring_buffer_bytes_peek(ring_buffer_bytes_t *handle,
+                                            void **data, uint32_t *size)
+{
+    if ((handle == NULL) || (data == NULL) || (size == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    uint32_t pos;
+    uint32_t *header = ring_buffer_bytes_front(handle, &pos);
+
+    if (header == NULL)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+
+    *data = (uint8_t *)header + RING_BUFFER_BYTES_HEADER_SIZE;
+    *size = header[0];
+
+    return RING_BUFFER_OK;
+}
+
+/* Drop the record returned by ring_buffer_bytes_peek() */
+ring_buffer_status_t ring_buffer_bytes_release(ring_buffer_bytes_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    uint32_t pos;
+    uint32_t *header = ring_buffer_bytes_front(handle, &pos);
+
+    if (header == NULL)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+
+    atomic_store_explicit(&handle->tail,
+                          pos + RING_BUFFER_BYTES_RECORD_SIZE(header[0]),
+                          memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Pop a record from the ring buffer */
+ring_buffer_status_t ring_buffer_bytes_pop(ring_buffer_bytes_t *handle,
+                                           void *data, uint32_t max_size,
+                                           uint32_t *size)
+{
+    if ((handle == NULL) || (size == NULL) ||
+        ((data == NULL) && (max_size != 0U)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    uint32_t pos;
+    uint32_t *header = ring_buffer_bytes_front(handle, &pos);
+
+    if (header == NULL)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+
+    *size = header[0];
+
+    if (header[0] > max_size)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (header[0] != 0U)
+    {
+        (void)memcpy(data, (uint8_t *)header + RING_BUFFER_BYTES_HEADER_SIZE,
+                     header[0]);
+    }
+
+    atomic_store_explicit(&handle->tail,
+                          pos + RING_BUFFER_BYTES_RECORD_SIZE(header[0]),
+                          memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Drop every record currently in the ring buffer */
+ring_buffer_status_t ring_buffer_bytes_drain(ring_buffer_bytes_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    handle->cached_head =
+        atomic_load_explicit(&handle->head, memory_order_acquire);
+    atomic_store_explicit(&handle->tail, handle->cached_head,
+                          memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the current state of the record ring buffer */
+ring_buffer_status_t
+ring_buffer_bytes_state(const ring_buffer_bytes_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    uint32_t tail = atomic_load_explicit(&handle->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&handle->head, memory_order_acquire);
+
+    return (head == tail) ? RING_BUFFER_EMPTY : RING_BUFFER_OK;
+}
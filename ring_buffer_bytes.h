@@ -0,0 +1,200 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_bytes.h                                                  *
+ * Description:                                                               *
+ *     Header file defining a lock-free single-producer/single-consumer       *
+ *     ring buffer of variable-length records.                                *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_BYTES_H_
+#define RING_BUFFER_BYTES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+
+/* Size of the inline header stored in front of every record */
+#define RING_BUFFER_BYTES_HEADER_SIZE 8U
+
+/* Records (header + payload) are padded to this alignment */
+#define RING_BUFFER_BYTES_ALIGN 8U
+
+/* Header length value marking padding up to the end of the buffer */
+#define RING_BUFFER_BYTES_SKIP 0xFFFFFFFFU
+
+/* Number of buffer bytes a record with a payload of size bytes occupies */
+#define RING_BUFFER_BYTES_RECORD_SIZE(size)                                    \
+    ((((uint32_t)(size) + RING_BUFFER_BYTES_HEADER_SIZE) +                     \
+      (RING_BUFFER_BYTES_ALIGN - 1U)) &                                        \
+     ~(RING_BUFFER_BYTES_ALIGN - 1U))
+
+/*
+ * Largest payload accepted by a ring of capacity bytes. A record of up to
+ * half the capacity plus the padding skipped before it always fits once the
+ * ring is empty, wherever head stands.
+ */
+#define RING_BUFFER_BYTES_MAX_PAYLOAD(capacity)                                \
+    (((uint32_t)(capacity) / 2U) - RING_BUFFER_BYTES_HEADER_SIZE)
+
+/*
+ * Structure representing the variable-length record ring buffer.
+ *
+ * Each record is an 8-byte header holding the payload length followed by
+ * the payload, padded to RING_BUFFER_BYTES_ALIGN. A record never wraps:
+ * when it does not fit before the end of the buffer the producer writes a
+ * RING_BUFFER_BYTES_SKIP header and starts over at offset 0, which is why
+ * payloads are limited to RING_BUFFER_BYTES_MAX_PAYLOAD(). head and tail
+ * are free-running byte counters owned by the producer and the consumer,
+ * laid out on separate cache lines as in ring_buffer_spsc_t.
+ */
+typedef struct
+{
+    uint8_t *buffer;          /* Pointer to the buffer memory */
+    uint32_t capacity;        /* Size of the buffer in bytes (power of two) */
+    uint32_t mask;            /* capacity - 1 */
+    uint8_t init_flag;        /* Initialization flag */
+
+    /* Producer-owned block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t head;    /* Next byte to write */
+    uint32_t cached_tail;     /* Producer's last observed tail */
+    uint32_t reserved_pad;    /* Skip bytes in front of the reservation */
+    uint32_t reserved_record; /* Record bytes reserved, 0 if none */
+
+    /* Consumer-owned block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t tail;    /* Next byte to read */
+    uint32_t cached_head;     /* Consumer's last observed head */
+} ring_buffer_bytes_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Initialize the record ring buffer.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param capacity Size of the buffer in bytes (power of two, 16 to 2^31).
+ * @param buffer   Pointer to the buffer memory, 8-byte aligned.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_bytes_init(ring_buffer_bytes_t *handle,
+                                            uint32_t capacity,
+                                            uint8_t *buffer);
+
+/**
+ * @brief Destroy the record ring buffer.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_bytes_destroy(ring_buffer_bytes_t *handle);
+
+/**
+ * @brief Reserve space for a record of up to size payload bytes.
+ *
+ * Producer side. The payload area is contiguous and 8-byte aligned; it is
+ * published by ring_buffer_bytes_commit().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param size   Maximum payload size in bytes (at most
+ *               RING_BUFFER_BYTES_MAX_PAYLOAD(capacity)).
+ * @param data   Pointer where the address of the payload area is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if no space).
+ */
+ring_buffer_status_t ring_buffer_bytes_reserve(ring_buffer_bytes_t *handle,
+                                               uint32_t size, void **data);
+
+/**
+ * @brief Publish the record written through ring_buffer_bytes_reserve().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param size   Actual payload size (at most the reserved size).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_bytes_commit(ring_buffer_bytes_t *handle,
+                                              uint32_t size);
+
+/**
+ * @brief Push a record into the ring buffer.
+ *
+ * Producer side.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param data   Pointer to the payload.
+ * @param size   Payload size in bytes (at most
+ *               RING_BUFFER_BYTES_MAX_PAYLOAD(capacity)).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_bytes_push(ring_buffer_bytes_t *handle,
+                                            const void *data, uint32_t size);
+
+/**
+ * @brief Access the oldest record without copying it out.
+ *
+ * Consumer side. The record stays in the ring until
+ * ring_buffer_bytes_release().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param data   Pointer where the address of the payload is stored.
+ * @param size   Pointer where the payload size is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if none).
+ */
+ring_buffer_status_t ring_buffer_bytes_peek(ring_buffer_bytes_t *handle,
+                                            void **data, uint32_t *size);
+
+/**
+ * @brief Drop the record returned by ring_buffer_bytes_peek().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_bytes_release(ring_buffer_bytes_t *handle);
+
+/**
+ * @brief Pop a record from the ring buffer.
+ *
+ * Consumer side. If the record does not fit in max_size bytes it is left
+ * in the ring and *size reports the size needed.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param data     Pointer where the payload will be stored.
+ * @param max_size Size of the destination in bytes.
+ * @param size     Pointer where the payload size is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_INVALID_PARAMS if
+ * the destination is too small).
+ */
+ring_buffer_status_t ring_buffer_bytes_pop(ring_buffer_bytes_t *handle,
+                                           void *data, uint32_t max_size,
+                                           uint32_t *size);
+
+/**
+ * @brief Drop every record currently in the ring buffer.
+ *
+ * Consumer side: tail is moved to the producer's latest head in one store.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_bytes_drain(ring_buffer_bytes_t *handle);
+
+/**
+ * @brief Get the current state of the record ring buffer.
+ *
+ * RING_BUFFER_FULL is never reported since fullness depends on the size of
+ * the next record.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY or
+ * RING_BUFFER_OK).
+ */
+ring_buffer_status_t
+ring_buffer_bytes_state(const ring_buffer_bytes_t *handle);
+
+#endif /* RING_BUFFER_BYTES_H_ */
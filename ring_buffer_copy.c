@@ -0,0 +1,95 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_copy.c                                                   *
+ * Description:                                                               *
+ *     Implementation of the non-temporal push copy and of its selection.     *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "ring_buffer_copy.h"
+#include <string.h>
+#include <stdint.h>
+
+#if !defined(RING_BUFFER_NO_COPY_KERNELS) && defined(__GNUC__) &&             \
+    defined(__x86_64__)
+#define RING_BUFFER_COPY_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef RING_BUFFER_COPY_X86
+/*
+ * Copy with SSE2 non-temporal stores, which bypass the cache. The stores
+ * need 16-byte aligned addresses, so the unaligned head and tail go
+ * through memcpy(). They are weakly ordered, hence the closing sfence.
+ */
+static void *ring_buffer_copy_stream(void *dst, const void *src, size_t size)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    size_t head = (16U - ((uintptr_t)d & 15U)) & 15U;
+
+    if (head > size)
+    {
+        head = size;
+    }
+
+    (void)memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+
+    for (; size >= 64U; size -= 64U, d += 64U, s += 64U)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(const void *)s);
+        __m128i b = _mm_loadu_si128((const __m128i *)(const void *)&s[16]);
+        __m128i c = _mm_loadu_si128((const __m128i *)(const void *)&s[32]);
+        __m128i e = _mm_loadu_si128((const __m128i *)(const void *)&s[48]);
+
+        _mm_stream_si128((__m128i *)(void *)d, a);
+        _mm_stream_si128((__m128i *)(void *)&d[16], b);
+        _mm_stream_si128((__m128i *)(void *)&d[32], c);
+        _mm_stream_si128((__m128i *)(void *)&d[48], e);
+    }
+
+    for (; size >= 16U; size -= 16U, d += 16U, s += 16U)
+    {
+        _mm_stream_si128((__m128i *)(void *)d,
+                         _mm_loadu_si128((const __m128i *)(const void *)s));
+    }
+
+    (void)memcpy(d, s, size);
+    _mm_sfence();
+
+    return dst;
+}
+#endif
+
+/* Pick the push copy for a ring of the given geometry */
+ring_buffer_status_t ring_buffer_copy_select(size_t element_size,
+                                             ring_buffer_index_t length,
+                                             ring_buffer_copy_fn_t *stream_in)
+{
+    if ((stream_in == NULL) || (length == 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    *stream_in = NULL;
+
+#ifdef RING_BUFFER_COPY_X86
+    if ((element_size >= RING_BUFFER_COPY_STREAM_MIN) &&
+        (element_size >= (RING_BUFFER_COPY_STREAM_BUFFER_MIN / length)))
+    {
+        *stream_in = ring_buffer_copy_stream;
+    }
+#else
+    (void)element_size;
+#endif
+
+    return RING_BUFFER_OK;
+}
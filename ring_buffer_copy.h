@@ -0,0 +1,60 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_copy.h                                                   *
+ * Description:                                                               *
+ *     Header file defining the non-temporal copy used for large pushes,      *
+ *     picked when a ring buffer is initialized.                              *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_COPY_H_
+#define RING_BUFFER_COPY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ring_buffer.h"
+
+/* Smallest element size pushed with non-temporal (streaming) stores */
+#ifndef RING_BUFFER_COPY_STREAM_MIN
+#define RING_BUFFER_COPY_STREAM_MIN 4096U
+#endif
+
+/*
+ * Smallest buffer pushed with non-temporal stores. A ring that fits in the
+ * cache is better served by regular stores: the consumer would otherwise
+ * have to fetch every element from memory.
+ */
+#ifndef RING_BUFFER_COPY_STREAM_BUFFER_MIN
+#define RING_BUFFER_COPY_STREAM_BUFFER_MIN (32U * 1024U * 1024U)
+#endif
+
+/* Function prototypes */
+
+/**
+ * @brief Pick the push copy for a ring of the given geometry.
+ *
+ * Pushes of elements of at least RING_BUFFER_COPY_STREAM_MIN bytes into
+ * buffers of at least RING_BUFFER_COPY_STREAM_BUFFER_MIN bytes use
+ * non-temporal stores on x86-64, so the data goes to memory without
+ * evicting the producer's working set. The kernel has completed its stores
+ * (fenced) when it returns, so the usual release store of the index
+ * publishes them. Every other push, and every pop, is a direct memcpy(),
+ * which the compiler can inline and libc already tunes for the CPU; that
+ * case is reported as NULL. Defining RING_BUFFER_NO_COPY_KERNELS never
+ * picks the streaming copy.
+ *
+ * @param element_size Size of each element in bytes.
+ * @param length       Number of elements in the buffer.
+ * @param stream_in    Pointer where the streaming copy, or NULL, is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_copy_select(size_t element_size,
+                                             ring_buffer_index_t length,
+                                             ring_buffer_copy_fn_t *stream_in);
+
+#endif /* RING_BUFFER_COPY_H_ */
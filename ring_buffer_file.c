@@ -0,0 +1,412 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_file.c                                                   *
+ * Description:                                                               *
+ *     Implementation of the memory-mapped persistent ring buffer file.       *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ring_buffer_file.h"
+#include <string.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* FNV-1a parameters */
+#define RING_BUFFER_FILE_FNV_OFFSET 0x811C9DC5U
+#define RING_BUFFER_FILE_FNV_PRIME 0x01000193U
+
+/* The header keeps 32-bit lengths and indices whatever the index width */
+#if RING_BUFFER_INDEX_BITS > 32
+#define RING_BUFFER_FILE_LENGTH_MAX 0x80000000U
+#else
+#define RING_BUFFER_FILE_LENGTH_MAX RING_BUFFER_INDEX_LENGTH_MAX
+#endif
+
+/* Checksum of every header byte before the checksum field */
+static uint32_t
+ring_buffer_file_checksum(const ring_buffer_file_header_t *header)
+{
+    const uint8_t *bytes = (const uint8_t *)header;
+    uint32_t hash = RING_BUFFER_FILE_FNV_OFFSET;
+
+    for (size_t i = 0U; i < offsetof(ring_buffer_file_header_t, checksum);
+         i++)
+    {
+        hash = (hash ^ bytes[i]) * RING_BUFFER_FILE_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/* Index n positions after the tail of ring, wrapped like the tail */
+static ring_buffer_index_t
+ring_buffer_file_after_tail(const ring_buffer_t *ring, ring_buffer_index_t n)
+{
+    if (ring->mask != 0U)
+    {
+        return (ring_buffer_index_t)(ring->tail + n);
+    }
+
+    /* Same wrap as ring_buffer_advance_tail(), without forming tail + n */
+    return (n >= (ring->length - ring->tail))
+               ? (n - (ring->length - ring->tail))
+               : (ring->tail + n);
+}
+
+#ifdef __linux__
+/* Pick the newest header copy that is intact, or NULL */
+static const ring_buffer_file_header_t *
+ring_buffer_file_latest(const ring_buffer_file_header_t *headers)
+{
+    const ring_buffer_file_header_t *latest = NULL;
+
+    for (uint32_t i = 0U; i < 2U; i++)
+    {
+        const ring_buffer_file_header_t *header = &headers[i];
+
+        if ((header->magic != RING_BUFFER_FILE_MAGIC) ||
+            (header->init_flag != RING_BUFFER_INITIALIZE_MASK) ||
+            (header->checksum != ring_buffer_file_checksum(header)))
+        {
+            continue;
+        }
+
+        if ((latest == NULL) || (header->sequence > latest->sequence))
+        {
+            latest = header;
+        }
+    }
+
+    return latest;
+}
+
+/* Check that saved indices are possible for the ring they belong to */
+static int ring_buffer_file_indices_valid(const ring_buffer_t *ring,
+                                          const ring_buffer_file_header_t *hdr)
+{
+    if (ring->mask != 0U)
+    {
+        /* Power-of-two mode: free-running counters */
+        return ((ring_buffer_index_t)(hdr->head - hdr->tail) <=
+                ring->length) &&
+               (hdr->is_full == 0U);
+    }
+
+    return (hdr->head < ring->length) && (hdr->tail < ring->length) &&
+           ((hdr->is_full == 0U) ||
+            ((hdr->is_full == 1U) && (hdr->head == hdr->tail)));
+}
+
+/* Map the whole file and set up the ring over its data area */
+static ring_buffer_status_t ring_buffer_file_map(ring_buffer_file_t *handle,
+                                                 int fd, size_t size,
+                                                 size_t data_offset,
+                                                 size_t element_size,
+                                                 ring_buffer_index_t length)
+{
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (base == MAP_FAILED)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_file_t));
+
+    handle->mapping = base;
+    handle->mapped_size = size;
+    handle->headers = base;
+    handle->fd = fd;
+
+    uint8_t *data = &handle->mapping[data_offset];
+    ring_buffer_status_t status =
+        ((length & (length - 1U)) == 0U)
+            ? ring_buffer_init_pow2(&handle->ring, element_size, length, data)
+            : ring_buffer_init(&handle->ring, element_size, length, data);
+
+    if (status != RING_BUFFER_OK)
+    {
+        (void)munmap(base, size);
+        (void)memset(handle, 0, sizeof(ring_buffer_file_t));
+    }
+
+    return status;
+}
+#endif
+
+/* Open a ring file, creating it if it does not exist */
+ring_buffer_status_t ring_buffer_file_open(ring_buffer_file_t *handle,
+                                           const char *path,
+                                           size_t element_size,
+                                           ring_buffer_index_t length)
+{
+    if ((handle == NULL) || (path == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((element_size == 0U) || (length < 2U) ||
+        (length > RING_BUFFER_FILE_LENGTH_MAX) ||
+        (element_size > ((SIZE_MAX / 2U) / length)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+#ifdef __linux__
+    long page = sysconf(_SC_PAGESIZE);
+
+    if ((page <= 0) ||
+        ((size_t)page < (2U * sizeof(ring_buffer_file_header_t))))
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    /* The headers get a page of their own so each area syncs separately */
+    size_t data_offset = (size_t)page;
+    size_t size = data_offset + (element_size * length);
+    struct flock lock = {0};
+    struct stat st;
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, RING_BUFFER_FILE_MODE);
+
+    if (fd < 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    /* One process at a time: the ring itself is not shared */
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+
+    if ((fcntl(fd, F_SETLK, &lock) != 0) || (fstat(fd, &st) != 0))
+    {
+        (void)close(fd);
+        return RING_BUFFER_FAIL;
+    }
+
+    int created = (st.st_size == 0);
+
+    if (created)
+    {
+        if (ftruncate(fd, (off_t)size) != 0)
+        {
+            (void)close(fd);
+            return RING_BUFFER_FAIL;
+        }
+    }
+    else if ((size_t)st.st_size < (2U * sizeof(ring_buffer_file_header_t)))
+    {
+        (void)close(fd);
+        return RING_BUFFER_FAIL;
+    }
+
+    /* An existing file is mapped as it is and checked against the header */
+    ring_buffer_status_t status =
+        ring_buffer_file_map(handle, fd,
+                             created ? size : (size_t)st.st_size,
+                             data_offset, element_size, length);
+
+    if (status != RING_BUFFER_OK)
+    {
+        (void)close(fd);
+        return status;
+    }
+
+    if (!created)
+    {
+        const ring_buffer_file_header_t *header =
+            ring_buffer_file_latest(handle->headers);
+
+        if (header == NULL)
+        {
+            status = RING_BUFFER_FAIL;
+        }
+        else if ((header->length != length) ||
+                 (header->element_size != element_size))
+        {
+            status = RING_BUFFER_INVALID_PARAMS;
+        }
+        else if ((header->data_offset != data_offset) ||
+                 (header->file_size != size) ||
+                 ((size_t)st.st_size != size) ||
+                 !ring_buffer_file_indices_valid(&handle->ring, header))
+        {
+            status = RING_BUFFER_FAIL;
+        }
+
+        if (status != RING_BUFFER_OK)
+        {
+            (void)munmap(handle->mapping, handle->mapped_size);
+            (void)close(fd);
+            (void)memset(handle, 0, sizeof(ring_buffer_file_t));
+            return status;
+        }
+
+        /* Resume from the last sync; only the distance survives truncation */
+        handle->ring.tail = header->tail;
+        handle->ring.head =
+            handle->ring.tail +
+            (ring_buffer_index_t)(header->head - header->tail);
+        handle->ring.is_full = header->is_full;
+        handle->ring.is_empty =
+            ((header->head == header->tail) && (header->is_full == 0U)) ? 1U
+                                                                        : 0U;
+        handle->sequence = header->sequence;
+    }
+
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    if (created && (ring_buffer_file_sync(handle) != RING_BUFFER_OK))
+    {
+        (void)ring_buffer_file_close(handle);
+        (void)unlink(path);
+        return RING_BUFFER_FAIL;
+    }
+
+    return RING_BUFFER_OK;
+#else
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Make the current ring contents durable */
+ring_buffer_status_t ring_buffer_file_sync(ring_buffer_file_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef __linux__
+    size_t data_offset = (size_t)(handle->ring.buffer - handle->mapping);
+
+    /* The data has to be on disk before a header that points at it */
+    if (msync(handle->ring.buffer, handle->mapped_size - data_offset,
+              MS_SYNC) != 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    /* The header already accounts for the pops it makes durable */
+    ring_buffer_index_t pending = handle->pending;
+    uint64_t sequence = handle->sequence + 1U;
+    ring_buffer_file_header_t *header = &handle->headers[sequence & 1U];
+
+    (void)memset(header, 0, sizeof(ring_buffer_file_header_t));
+    header->magic = RING_BUFFER_FILE_MAGIC;
+    header->length = (uint32_t)handle->ring.length;
+    header->element_size = handle->ring.element_size;
+    header->data_offset = data_offset;
+    header->file_size = handle->mapped_size;
+    header->sequence = sequence;
+    header->head = (uint32_t)handle->ring.head;
+    header->tail =
+        (uint32_t)ring_buffer_file_after_tail(&handle->ring, pending);
+    header->init_flag = RING_BUFFER_INITIALIZE_MASK;
+    header->is_full = (pending == 0U) ? handle->ring.is_full : 0U;
+    header->checksum = ring_buffer_file_checksum(header);
+
+    if (msync(handle->mapping, data_offset, MS_SYNC) != 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    handle->sequence = sequence;
+
+    /* Only now may the producer reuse the slots of the synced pops */
+    (void)ring_buffer_release(&handle->ring, pending);
+    handle->pending = 0U;
+
+    return RING_BUFFER_OK;
+#else
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Pop the oldest element not popped since the last sync */
+ring_buffer_status_t ring_buffer_file_pop(ring_buffer_file_t *handle,
+                                          void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t size = 0U;
+
+    (void)ring_buffer_size(&handle->ring, &size);
+
+    if (handle->pending >= size)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+
+    /* Read in place; the tail stays put until the pop is synced */
+    ring_buffer_index_t pos =
+        ring_buffer_file_after_tail(&handle->ring, handle->pending);
+    ring_buffer_index_t slot =
+        (handle->ring.mask != 0U) ? (pos & handle->ring.mask) : pos;
+
+    (void)memcpy(element,
+                 &handle->ring.buffer[(size_t)slot * handle->ring.element_size],
+                 handle->ring.element_size);
+    handle->pending++;
+
+    return RING_BUFFER_OK;
+}
+
+/* Sync and close a ring file */
+ring_buffer_status_t ring_buffer_file_close(ring_buffer_file_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_status_t status = ring_buffer_file_sync(handle);
+
+    (void)ring_buffer_destroy(&handle->ring);
+
+#ifdef __linux__
+    (void)munmap(handle->mapping, handle->mapped_size);
+    (void)close(handle->fd);
+#endif
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_file_t));
+
+    return status;
+}
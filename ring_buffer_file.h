@@ -0,0 +1,136 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_file.h                                                   *
+ * Description:                                                               *
+ *     Header file defining a ring buffer kept in a memory-mapped file, so    *
+ *     that its contents survive a crash and can be replayed on restart.      *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_FILE_H_
+#define RING_BUFFER_FILE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ring_buffer.h"
+
+/* Value stored in a valid file header ("RBF" v1) */
+#define RING_BUFFER_FILE_MAGIC 0x52424601U
+
+/* Permissions of newly created ring files */
+#ifndef RING_BUFFER_FILE_MODE
+#define RING_BUFFER_FILE_MODE 0600
+#endif
+
+/*
+ * Header describing the ring state at the last sync.
+ *
+ * The file starts with two copies that are written alternately, so a
+ * crash in the middle of a sync leaves the previous one intact. The copy
+ * with a valid checksum and the highest sequence wins on reopen. Only
+ * fixed-width fields, without padding, so the checksum covers every byte
+ * before it.
+ */
+typedef struct
+{
+    uint32_t magic;        /* RING_BUFFER_FILE_MAGIC */
+    uint32_t length;       /* Number of elements in the buffer */
+    uint64_t element_size; /* Size of each element in bytes */
+    uint64_t data_offset;  /* Offset of the data area in the file */
+    uint64_t file_size;    /* Size of the whole file in bytes */
+    uint64_t sequence;     /* Number of syncs so far */
+    uint32_t head;         /* ring_buffer_t head at the sync */
+    uint32_t tail;         /* ring_buffer_t tail at the sync */
+    uint8_t init_flag;     /* RING_BUFFER_INITIALIZE_MASK */
+    uint8_t is_full;       /* ring_buffer_t is_full at the sync */
+    uint8_t reserved[2];   /* Zero */
+    uint32_t checksum;     /* FNV-1a of the fields above */
+} ring_buffer_file_header_t;
+
+/*
+ * Structure representing an open ring file.
+ *
+ * ring is a regular ring buffer over the mapped data area. Producers push
+ * with the ring_buffer_*() functions; consumers pop with
+ * ring_buffer_file_pop(), whose slots stay taken until the next
+ * ring_buffer_file_sync(), so a replay never finds them reused. The file
+ * only sees the indices when ring_buffer_file_sync() is called.
+ */
+typedef struct
+{
+    ring_buffer_t ring;                 /* Ring over the data area */
+    ring_buffer_file_header_t *headers; /* The two header copies */
+    uint8_t *mapping;                   /* Start of the file mapping */
+    size_t mapped_size;                 /* Size of the mapping in bytes */
+    uint64_t sequence;                  /* Sequence of the last sync */
+    ring_buffer_index_t pending;        /* Pops not synced yet */
+    int fd;                             /* Open file descriptor */
+    uint8_t init_flag;                  /* Initialization flag */
+} ring_buffer_file_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Open a ring file, creating it if it does not exist.
+ *
+ * An existing file is validated (magic, RING_BUFFER_INITIALIZE_MASK,
+ * header checksum and geometry) and the ring resumes with the elements it
+ * held at the last ring_buffer_file_sync(). Only available on Linux.
+ *
+ * @param handle       Pointer to the ring file handle.
+ * @param path         Path of the file.
+ * @param element_size Size of each element in bytes.
+ * @param length       Number of elements in the buffer.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_INVALID_PARAMS if
+ * the file holds a ring of another geometry, RING_BUFFER_FAIL if it cannot
+ * be opened or no header copy is valid).
+ */
+ring_buffer_status_t ring_buffer_file_open(ring_buffer_file_t *handle,
+                                           const char *path,
+                                           size_t element_size,
+                                           ring_buffer_index_t length);
+
+/**
+ * @brief Pop the oldest element not popped since the last sync.
+ *
+ * The element's slot is only freed by the next ring_buffer_file_sync(), so
+ * until then pushes may return RING_BUFFER_FULL. After a crash the elements
+ * popped since the last sync are replayed unchanged and in order.
+ *
+ * @param handle  Pointer to the ring file handle.
+ * @param element Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if every
+ * element has been popped).
+ */
+ring_buffer_status_t ring_buffer_file_pop(ring_buffer_file_t *handle,
+                                          void *element);
+
+/**
+ * @brief Make the current ring contents durable.
+ *
+ * Writes the data area back, then the indices into the older header copy,
+ * and waits for both to reach the disk. Only then are the slots of the
+ * elements popped with ring_buffer_file_pop() freed. Call it once per batch
+ * of pushes and pops rather than after each one.
+ *
+ * @param handle Pointer to the ring file handle.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the file
+ * could not be written).
+ */
+ring_buffer_status_t ring_buffer_file_sync(ring_buffer_file_t *handle);
+
+/**
+ * @brief Sync and close a ring file.
+ *
+ * @param handle Pointer to the ring file handle.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the final
+ * sync failed; the file is closed anyway).
+ */
+ring_buffer_status_t ring_buffer_file_close(ring_buffer_file_t *handle);
+
+#endif /* RING_BUFFER_FILE_H_ */
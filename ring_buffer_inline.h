@@ -0,0 +1,379 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_inline.h                                                 *
+ * Description:                                                               *
+ *     Header file defining header-inline push/pop fast paths that skip the   *
+ *     per-call parameter validation of the regular API.                      *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_INLINE_H_
+#define RING_BUFFER_INLINE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_internal.h"
+
+/*
+ * The *_unchecked functions below are what ring_buffer_push() and friends
+ * run after validating their arguments. Calling them directly skips the
+ * NULL and init_flag checks and lets the compiler inline the whole
+ * operation into the caller: handle and element must be valid and the ring
+ * initialized, otherwise the behaviour is undefined. Status codes and
+ * statistics are the same as for the checked calls.
+ */
+
+/* Inline function to get the number of elements in the ring buffer */
+static inline ring_buffer_index_t ring_buffer_count(const ring_buffer_t *handle)
+{
+    if (handle->mask != 0U)
+    {
+        return (ring_buffer_index_t)(handle->head - handle->tail);
+    }
+
+    if (handle->is_full != 0U)
+    {
+        return handle->length;
+    }
+
+    return (handle->head >= handle->tail)
+               ? (handle->head - handle->tail)
+               : (handle->length - handle->tail + handle->head);
+}
+
+/* Inline function to account for n elements pushed into the ring buffer */
+static inline void ring_buffer_stats_push(ring_buffer_t *handle,
+                                          ring_buffer_index_t n)
+{
+#ifdef RING_BUFFER_ENABLE_STATS
+    RING_BUFFER_STAT_ADD(handle->producer_stats.pushes, n);
+    ring_buffer_stat_watermark(&handle->producer_stats.high_watermark,
+                               ring_buffer_count(handle));
+#else
+    (void)handle;
+    (void)n;
+#endif
+}
+
+/* Inline function to advance an index by n positions */
+static inline ring_buffer_index_t
+ring_buffer_spsc_next_index(const ring_buffer_spsc_t *handle,
+                            ring_buffer_index_t index, ring_buffer_index_t n)
+{
+    if (handle->mask != 0U)
+    {
+        return (ring_buffer_index_t)(index + n);
+    }
+
+    /* Wrap at 2 * length without forming index + n, which may not fit */
+    ring_buffer_index_t room =
+        (ring_buffer_index_t)((2U * handle->length) - n);
+
+    return (index >= room) ? (ring_buffer_index_t)(index - room)
+                           : (ring_buffer_index_t)(index + n);
+}
+
+/* Inline function to map an index onto its slot in the buffer */
+static inline ring_buffer_index_t
+ring_buffer_spsc_slot(const ring_buffer_spsc_t *handle,
+                      ring_buffer_index_t index)
+{
+    if (handle->mask != 0U)
+    {
+        return index & handle->mask;
+    }
+
+    return (index >= handle->length) ? (index - handle->length) : index;
+}
+
+/* Inline function to get the number of elements between tail and head */
+static inline ring_buffer_index_t
+ring_buffer_spsc_count(const ring_buffer_spsc_t *handle,
+                       ring_buffer_index_t head, ring_buffer_index_t tail)
+{
+    if ((handle->mask != 0U) || (head >= tail))
+    {
+        return (ring_buffer_index_t)(head - tail);
+    }
+
+    return (2U * handle->length) - tail + head;
+}
+
+/* Inline function to account for n elements pushed, head being the new head */
+static inline void ring_buffer_spsc_stats_push(ring_buffer_spsc_t *handle,
+                                               ring_buffer_index_t head,
+                                               ring_buffer_index_t n)
+{
+#ifdef RING_BUFFER_ENABLE_STATS
+    RING_BUFFER_STAT_ADD(handle->producer_stats.pushes, n);
+
+    /* cached_tail can be stale: confirm against tail before raising */
+    if (ring_buffer_spsc_count(handle, head, handle->cached_tail) >
+        atomic_load_explicit(&handle->producer_stats.high_watermark,
+                             memory_order_relaxed))
+    {
+        handle->cached_tail =
+            atomic_load_explicit(&handle->tail, memory_order_acquire);
+        ring_buffer_stat_watermark(
+            &handle->producer_stats.high_watermark,
+            ring_buffer_spsc_count(handle, head, handle->cached_tail));
+    }
+#else
+    (void)handle;
+    (void)head;
+    (void)n;
+#endif
+}
+
+/*
+ * Inline function to prefetch for writing the cache lines that start in the
+ * n slots lying prefetch_distance slots after index, so that the producer
+ * already owns them when it gets there
+ */
+static inline void
+ring_buffer_spsc_prefetch(const ring_buffer_spsc_t *handle,
+                          ring_buffer_index_t index, ring_buffer_index_t n)
+{
+    if (handle->prefetch_distance == 0U)
+    {
+        return;
+    }
+
+    size_t size = (size_t)handle->length * handle->element_size;
+    size_t slot = (size_t)ring_buffer_spsc_slot(handle, index) +
+                  handle->prefetch_distance;
+
+    if (slot >= handle->length)
+    {
+        slot -= handle->length;
+    }
+
+    size_t start = slot * handle->element_size;
+    size_t end = start + ((size_t)n * handle->element_size);
+
+    for (size_t line = (start + (RING_BUFFER_CACHE_LINE_SIZE - 1U)) &
+                       ~((size_t)RING_BUFFER_CACHE_LINE_SIZE - 1U);
+         line < end; line += RING_BUFFER_CACHE_LINE_SIZE)
+    {
+        ring_buffer_prefetch_write(
+            &handle->buffer[(line < size) ? line : (line - size)]);
+    }
+}
+
+/**
+ * @brief Push an element into the ring buffer without validation.
+ *
+ * @param handle Pointer to an initialized ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_OK or
+ * RING_BUFFER_FULL).
+ */
+static inline ring_buffer_status_t
+ring_buffer_push_unchecked(ring_buffer_t *handle, const void *element)
+{
+    if (handle->mask != 0U)
+    {
+        /* Power-of-two mode: free-running counters, no flags to update */
+        if ((ring_buffer_index_t)(handle->head - handle->tail) ==
+            handle->length)
+        {
+            RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+            return RING_BUFFER_FULL;
+        }
+
+        size_t offset = (size_t)(handle->head & handle->mask) *
+                        handle->element_size;
+        ring_buffer_store(handle->stream_in, &handle->buffer[offset], element,
+                          handle->element_size);
+        RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                                  handle->head & handle->mask, 1U);
+        handle->head++;
+        ring_buffer_stats_push(handle, 1U);
+
+        return RING_BUFFER_OK;
+    }
+
+    if (handle->is_full != 0U)
+    {
+        RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+        return RING_BUFFER_FULL;
+    }
+
+    /* Copy the element into the buffer at the head position */
+    size_t offset = (size_t)handle->head * handle->element_size;
+    ring_buffer_store(handle->stream_in, &handle->buffer[offset], element,
+                      handle->element_size);
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length, handle->head,
+                              1U);
+
+    /* Update the head position and check if the buffer is now full */
+    handle->head = ((handle->head + 1U) == handle->length)
+                       ? 0U
+                       : (handle->head + 1U);
+    handle->is_full = (handle->head == handle->tail) ? 1U : 0U;
+    handle->is_empty = 0U;
+    ring_buffer_stats_push(handle, 1U);
+
+    return RING_BUFFER_OK;
+}
+
+/**
+ * @brief Pop an element from the ring buffer without validation.
+ *
+ * @param handle Pointer to an initialized ring buffer handle.
+ * @param element Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_OK or
+ * RING_BUFFER_EMPTY).
+ */
+static inline ring_buffer_status_t
+ring_buffer_pop_unchecked(ring_buffer_t *handle, void *element)
+{
+    if (handle->mask != 0U)
+    {
+        /* Power-of-two mode: free-running counters, no flags to update */
+        if (handle->head == handle->tail)
+        {
+            RING_BUFFER_STAT_ADD(handle->consumer_stats.empty_rejects, 1U);
+            return RING_BUFFER_EMPTY;
+        }
+
+        size_t offset = (size_t)(handle->tail & handle->mask) *
+                        handle->element_size;
+        (void)memcpy(element, &handle->buffer[offset], handle->element_size);
+        RING_BUFFER_LATENCY_RECORD(handle->latency, handle->stamps,
+                                   handle->length,
+                                   handle->tail & handle->mask, 1U);
+        handle->tail++;
+        RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, 1U);
+
+        return RING_BUFFER_OK;
+    }
+
+    if (handle->is_empty != 0U)
+    {
+        RING_BUFFER_STAT_ADD(handle->consumer_stats.empty_rejects, 1U);
+        return RING_BUFFER_EMPTY;
+    }
+
+    /* Copy the element from the buffer at the tail position */
+    size_t offset = (size_t)handle->tail * handle->element_size;
+    (void)memcpy(element, &handle->buffer[offset], handle->element_size);
+    RING_BUFFER_LATENCY_RECORD(handle->latency, handle->stamps, handle->length,
+                               handle->tail, 1U);
+
+    /* Update the tail position and check if the buffer is now empty */
+    handle->tail = ((handle->tail + 1U) == handle->length)
+                       ? 0U
+                       : (handle->tail + 1U);
+    handle->is_empty = (handle->head == handle->tail) ? 1U : 0U;
+    handle->is_full = 0U;
+    RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, 1U);
+
+    return RING_BUFFER_OK;
+}
+
+/**
+ * @brief Push an element into the SPSC ring buffer without validation.
+ *
+ * Must only be called from the single producer thread.
+ *
+ * @param handle Pointer to an initialized ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_OK or
+ * RING_BUFFER_FULL).
+ */
+static inline ring_buffer_status_t
+ring_buffer_spsc_push_unchecked(ring_buffer_spsc_t *handle,
+                                const void *element)
+{
+    /* The producer owns head; tail is only reloaded when it looks full */
+    ring_buffer_index_t head = handle->local_head;
+
+    if (ring_buffer_spsc_count(handle, head, handle->cached_tail) ==
+        handle->length)
+    {
+        handle->cached_tail =
+            atomic_load_explicit(&handle->tail, memory_order_acquire);
+
+        if (ring_buffer_spsc_count(handle, head, handle->cached_tail) ==
+            handle->length)
+        {
+            RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+            return RING_BUFFER_FULL;
+        }
+    }
+
+    /* Copy the element into the buffer at the head position */
+    size_t offset =
+        (size_t)ring_buffer_spsc_slot(handle, head) * handle->element_size;
+    ring_buffer_store(handle->stream_in, &handle->buffer[offset], element,
+                      handle->element_size);
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                              ring_buffer_spsc_slot(handle, head), 1U);
+    ring_buffer_spsc_prefetch(handle, head, 1U);
+
+    /* Publish the element to the consumer */
+    head = ring_buffer_spsc_next_index(handle, head, 1U);
+    handle->local_head = head;
+    atomic_store_explicit(&handle->head, head, memory_order_release);
+    ring_buffer_spsc_stats_push(handle, head, 1U);
+
+    return RING_BUFFER_OK;
+}
+
+/**
+ * @brief Pop an element from the SPSC ring buffer without validation.
+ *
+ * Must only be called from the single consumer thread.
+ *
+ * @param handle Pointer to an initialized ring buffer handle.
+ * @param element Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_OK or
+ * RING_BUFFER_EMPTY).
+ */
+static inline ring_buffer_status_t
+ring_buffer_spsc_pop_unchecked(ring_buffer_spsc_t *handle, void *element)
+{
+    /* The consumer owns tail; head is only reloaded when it looks empty */
+    ring_buffer_index_t tail = handle->local_tail;
+
+    if (handle->cached_head == tail)
+    {
+        handle->cached_head =
+            atomic_load_explicit(&handle->head, memory_order_acquire);
+
+        if (handle->cached_head == tail)
+        {
+            /* Give the producer the room of any deferred pops back */
+            atomic_store_explicit(&handle->tail, tail, memory_order_release);
+            RING_BUFFER_STAT_ADD(handle->consumer_stats.empty_rejects, 1U);
+            return RING_BUFFER_EMPTY;
+        }
+    }
+
+    /* Copy the element from the buffer at the tail position */
+    size_t offset =
+        (size_t)ring_buffer_spsc_slot(handle, tail) * handle->element_size;
+    (void)memcpy(element, &handle->buffer[offset], handle->element_size);
+    RING_BUFFER_LATENCY_RECORD(handle->latency, handle->stamps, handle->length,
+                               ring_buffer_spsc_slot(handle, tail), 1U);
+
+    /* Hand the slot back to the producer */
+    handle->local_tail = ring_buffer_spsc_next_index(handle, tail, 1U);
+    atomic_store_explicit(&handle->tail, handle->local_tail,
+                          memory_order_release);
+    RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, 1U);
+
+    return RING_BUFFER_OK;
+}
+
+#endif /* RING_BUFFER_INLINE_H_ */
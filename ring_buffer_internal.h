@@ -0,0 +1,337 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_internal.h                                               *
+ * Description:                                                               *
+ *     Private helpers shared by the ring buffer variants. Not part of the    *
+ *     public API.                                                            *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_INTERNAL_H_
+#define RING_BUFFER_INTERNAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "ring_buffer.h"
+
+/* Hint to the CPU that the caller is spinning on a shared location */
+static inline void ring_buffer_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+/* Hint to the CPU that the cache line at addr is about to be written */
+static inline void ring_buffer_prefetch_write(const void *addr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr, 1, 3);
+#else
+    (void)addr;
+#endif
+}
+
+/*
+ * memset() called through a volatile pointer, so that wiping memory that is
+ * never read again cannot be optimized away
+ */
+static void *(*const volatile ring_buffer_wipe_fn)(void *, int, size_t) =
+    memset;
+
+/* Overwrite size bytes with zeros, even if they are dead afterwards */
+static inline void ring_buffer_secure_wipe(void *buffer, size_t size)
+{
+    (void)ring_buffer_wipe_fn(buffer, 0, size);
+}
+
+/*
+ * Copy size bytes into the buffer with the streaming kernel the ring picked,
+ * or with a direct memcpy() (which the compiler can inline) when it is NULL
+ */
+static inline void ring_buffer_store(ring_buffer_copy_fn_t stream, void *dst,
+                                     const void *src, size_t size)
+{
+    if (stream != NULL)
+    {
+        (void)stream(dst, src, size);
+        return;
+    }
+
+    (void)memcpy(dst, src, size);
+}
+
+/*
+ * Copy n elements into the buffer starting at slot, splitting the transfer
+ * in at most two stores around the end of the buffer. span is the number of
+ * slots addressable from buffer before wrapping: the length, or twice the
+ * length for a mirrored buffer (which never splits). stream is passed on to
+ * ring_buffer_store().
+ */
+static inline void ring_buffer_copy_in(ring_buffer_copy_fn_t stream,
+                                       uint8_t *buffer,
+                                       ring_buffer_index_t span,
+                                       size_t element_size,
+                                       ring_buffer_index_t slot,
+                                       const uint8_t *src,
+                                       ring_buffer_index_t n)
+{
+    ring_buffer_index_t first = span - slot;
+
+    if (first > n)
+    {
+        first = n;
+    }
+
+    ring_buffer_store(stream, &buffer[(size_t)slot * element_size], src,
+                      (size_t)first * element_size);
+
+    if (n > first)
+    {
+        ring_buffer_store(stream, buffer, &src[(size_t)first * element_size],
+                          (size_t)(n - first) * element_size);
+    }
+}
+
+/*
+ * Copy n elements out of the buffer starting at slot, splitting the transfer
+ * in at most two memcpy() calls around the end of the buffer. span has the
+ * same meaning as for ring_buffer_copy_in().
+ */
+static inline void ring_buffer_copy_out(const uint8_t *buffer,
+                                        ring_buffer_index_t span,
+                                        size_t element_size,
+                                        ring_buffer_index_t slot, uint8_t *dst,
+                                        ring_buffer_index_t n)
+{
+    ring_buffer_index_t first = span - slot;
+
+    if (first > n)
+    {
+        first = n;
+    }
+
+    (void)memcpy(dst, &buffer[(size_t)slot * element_size],
+                 (size_t)first * element_size);
+
+    if (n > first)
+    {
+        (void)memcpy(&dst[(size_t)first * element_size], buffer,
+                     (size_t)(n - first) * element_size);
+    }
+}
+
+#ifdef RING_BUFFER_ENABLE_STATS
+/* Add n to a counter that only the calling side ever writes */
+static inline void ring_buffer_stat_add(_Atomic uint64_t *counter, uint64_t n)
+{
+    atomic_store_explicit(
+        counter, atomic_load_explicit(counter, memory_order_relaxed) + n,
+        memory_order_relaxed);
+}
+
+/* Add n to a counter written by several threads of the same side */
+static inline void ring_buffer_stat_shared_add(_Atomic uint64_t *counter,
+                                               uint64_t n)
+{
+    (void)atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+}
+
+/* Raise a high watermark to count, tolerating concurrent writers */
+static inline void
+ring_buffer_stat_watermark(_Atomic ring_buffer_index_t *watermark,
+                           ring_buffer_index_t count)
+{
+    ring_buffer_index_t current =
+        atomic_load_explicit(watermark, memory_order_relaxed);
+
+    while ((count > current) &&
+           !atomic_compare_exchange_weak_explicit(watermark, &current, count,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+    {
+    }
+}
+
+/* Copy the per-side counters into a snapshot */
+static inline void
+ring_buffer_stats_read(const ring_buffer_producer_stats_t *producer,
+                       const ring_buffer_consumer_stats_t *consumer,
+                       ring_buffer_stats_t *stats)
+{
+    stats->pushes =
+        atomic_load_explicit(&producer->pushes, memory_order_relaxed);
+    stats->full_rejects =
+        atomic_load_explicit(&producer->full_rejects, memory_order_relaxed);
+    stats->overwrites =
+        atomic_load_explicit(&producer->overwrites, memory_order_relaxed);
+    stats->high_watermark =
+        atomic_load_explicit(&producer->high_watermark, memory_order_relaxed);
+    stats->pops = atomic_load_explicit(&consumer->pops, memory_order_relaxed);
+    stats->empty_rejects =
+        atomic_load_explicit(&consumer->empty_rejects, memory_order_relaxed);
+}
+
+#define RING_BUFFER_STAT_ADD(counter, n)                                       \
+    ring_buffer_stat_add(&(counter), (uint64_t)(n))
+#define RING_BUFFER_STAT_SHARED_ADD(counter, n)                                \
+    ring_buffer_stat_shared_add(&(counter), (uint64_t)(n))
+#else
+/* Statistics are compiled out: the arguments are never evaluated */
+#define RING_BUFFER_STAT_ADD(counter, n) ((void)0)
+#define RING_BUFFER_STAT_SHARED_ADD(counter, n) ((void)0)
+#endif
+
+#ifdef RING_BUFFER_ENABLE_LATENCY
+#ifndef RING_BUFFER_LATENCY_CLOCK
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RING_BUFFER_LATENCY_CLOCK() ((uint64_t)__rdtsc())
+#elif defined(__aarch64__)
+/* Read the virtual counter, which runs at a fixed rate on every core */
+static inline uint64_t ring_buffer_latency_cntvct(void)
+{
+    uint64_t value;
+
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(value));
+
+    return value;
+}
+
+#define RING_BUFFER_LATENCY_CLOCK() ring_buffer_latency_cntvct()
+#else
+#include <time.h>
+
+/* Read the C11 clock in nanoseconds */
+static inline uint64_t ring_buffer_latency_ns(void)
+{
+    struct timespec ts;
+
+    (void)timespec_get(&ts, TIME_UTC);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+#define RING_BUFFER_LATENCY_CLOCK() ring_buffer_latency_ns()
+#endif
+#endif
+
+/* Histogram bucket of a dwell time: floor(log2(ticks)) + 1, 0 for 0 */
+static inline uint32_t ring_buffer_latency_bucket(uint64_t ticks)
+{
+    uint32_t bucket = 0U;
+
+#if defined(__GNUC__) || defined(__clang__)
+    if (ticks != 0U)
+    {
+        bucket = 64U - (uint32_t)__builtin_clzll(ticks);
+    }
+#else
+    while (ticks != 0U)
+    {
+        ticks >>= 1U;
+        bucket++;
+    }
+#endif
+
+    return (bucket < RING_BUFFER_LATENCY_BUCKETS)
+               ? bucket
+               : (RING_BUFFER_LATENCY_BUCKETS - 1U);
+}
+
+/* Stamp n slots starting at slot (wrapping at length) with the time */
+static inline void ring_buffer_latency_stamp(uint64_t *stamps,
+                                             ring_buffer_index_t length,
+                                             ring_buffer_index_t slot,
+                                             ring_buffer_index_t n)
+{
+    if ((stamps == NULL) || (n == 0U))
+    {
+        return;
+    }
+
+    uint64_t now = RING_BUFFER_LATENCY_CLOCK();
+
+    for (ring_buffer_index_t i = 0U; i < n; i++)
+    {
+        stamps[slot] = now;
+        slot = ((slot + 1U) == length) ? 0U : (slot + 1U);
+    }
+}
+
+/* Record the dwell time of n slots starting at slot (wrapping at length) */
+static inline void
+ring_buffer_latency_record(ring_buffer_latency_histogram_t *histogram,
+                           const uint64_t *stamps, ring_buffer_index_t length,
+                           ring_buffer_index_t slot, ring_buffer_index_t n)
+{
+    if ((stamps == NULL) || (n == 0U))
+    {
+        return;
+    }
+
+    uint64_t now = RING_BUFFER_LATENCY_CLOCK();
+    uint64_t total = 0U;
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+
+    /* Only the consumer side writes, so load + store is enough */
+    for (ring_buffer_index_t i = 0U; i < n; i++)
+    {
+        /* Clocks of different cores may disagree by a few ticks */
+        uint64_t ticks = (now > stamps[slot]) ? (now - stamps[slot]) : 0U;
+        _Atomic uint64_t *bucket =
+            &histogram->buckets[ring_buffer_latency_bucket(ticks)];
+
+        atomic_store_explicit(
+            bucket, atomic_load_explicit(bucket, memory_order_relaxed) + 1U,
+            memory_order_relaxed);
+        total += ticks;
+        max = (ticks > max) ? ticks : max;
+        slot = ((slot + 1U) == length) ? 0U : (slot + 1U);
+    }
+
+    atomic_store_explicit(
+        &histogram->total,
+        atomic_load_explicit(&histogram->total, memory_order_relaxed) + total,
+        memory_order_relaxed);
+    atomic_store_explicit(&histogram->max, max, memory_order_relaxed);
+}
+
+/* Copy a dwell-time histogram into a snapshot */
+static inline void
+ring_buffer_latency_read(const ring_buffer_latency_histogram_t *histogram,
+                         ring_buffer_latency_t *latency)
+{
+    latency->count = 0U;
+
+    for (uint32_t i = 0U; i < RING_BUFFER_LATENCY_BUCKETS; i++)
+    {
+        latency->buckets[i] =
+            atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        latency->count += latency->buckets[i];
+    }
+
+    latency->total =
+        atomic_load_explicit(&histogram->total, memory_order_relaxed);
+    latency->max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+}
+
+#define RING_BUFFER_LATENCY_STAMP(stamps, length, slot, n)                     \
+    ring_buffer_latency_stamp((stamps), (length), (slot), (n))
+#define RING_BUFFER_LATENCY_RECORD(histogram, stamps, length, slot, n)         \
+    ring_buffer_latency_record(&(histogram), (stamps), (length), (slot), (n))
+#else
+/* Latency measurement is compiled out: the arguments are never evaluated */
+#define RING_BUFFER_LATENCY_STAMP(stamps, length, slot, n) ((void)0)
+#define RING_BUFFER_LATENCY_RECORD(histogram, stamps, length, slot, n) ((void)0)
+#endif
+
+#endif /* RING_BUFFER_INTERNAL_H_ */
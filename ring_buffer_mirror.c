@@ -0,0 +1,134 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_mirror.c                                                 *
+ * Description:                                                               *
+ *     Implementation of the virtual-memory mirrored buffer functions.        *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "ring_buffer_mirror.h"
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* Get the granularity mirrored buffer sizes must be a multiple of */
+size_t ring_buffer_mirror_granularity(void)
+{
+#ifdef __linux__
+    long page = sysconf(_SC_PAGESIZE);
+
+    return (page > 0) ? (size_t)page : 0U;
+#else
+    return 0U;
+#endif
+}
+
+/* Map a mirrored buffer */
+ring_buffer_status_t ring_buffer_mirror_init(ring_buffer_mirror_t *mirror,
+                                             size_t size)
+{
+    if (mirror == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (mirror->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    size_t granularity = ring_buffer_mirror_granularity();
+
+    if (granularity == 0U)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    if ((size == 0U) || ((size % granularity) != 0U) ||
+        (size > (SIZE_MAX / 2U)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+#ifdef __linux__
+    int fd = memfd_create("ring_buffer", MFD_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        (void)close(fd);
+        return RING_BUFFER_FAIL;
+    }
+
+    /* Reserve the whole range first so both halves land back-to-back */
+    uint8_t *base = mmap(NULL, 2U * size, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (base == MAP_FAILED)
+    {
+        (void)close(fd);
+        return RING_BUFFER_FAIL;
+    }
+
+    if ((mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+              0) == MAP_FAILED) ||
+        (mmap(base + size, size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED))
+    {
+        (void)munmap(base, 2U * size);
+        (void)close(fd);
+        return RING_BUFFER_FAIL;
+    }
+
+    /* The mappings keep the pages alive */
+    (void)close(fd);
+
+    /* Clear the handle structure */
+    (void)memset(mirror, 0, sizeof(ring_buffer_mirror_t));
+
+    mirror->buffer = base;
+    mirror->size = size;
+    mirror->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+#else
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Unmap a mirrored buffer */
+ring_buffer_status_t ring_buffer_mirror_destroy(ring_buffer_mirror_t *mirror)
+{
+    if (mirror == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (mirror->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef __linux__
+    (void)munmap(mirror->buffer, 2U * mirror->size);
+#endif
+
+    /* Clear the handle structure */
+    (void)memset(mirror, 0, sizeof(ring_buffer_mirror_t));
+
+    return RING_BUFFER_OK;
+}
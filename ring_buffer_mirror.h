@@ -0,0 +1,68 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_mirror.h                                                 *
+ * Description:                                                               *
+ *     Header file defining virtual-memory mirrored buffers, where the same   *
+ *     pages are mapped twice back-to-back so that wraparound spans are       *
+ *     contiguous.                                                            *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_MIRROR_H_
+#define RING_BUFFER_MIRROR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ring_buffer.h"
+
+/*
+ * Structure representing a mirrored buffer.
+ *
+ * buffer[i] and buffer[i + size] alias the same byte for every i < size, so
+ * any span of up to size bytes starting inside the first copy can be read or
+ * written through a single pointer.
+ */
+typedef struct
+{
+    uint8_t *buffer;   /* Start of the first mapping */
+    size_t size;       /* Size of one mapping in bytes */
+    uint8_t init_flag; /* Initialization flag */
+} ring_buffer_mirror_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Get the granularity mirrored buffer sizes must be a multiple of.
+ *
+ * @return size_t Page size in bytes, or 0 if mirroring is not supported.
+ */
+size_t ring_buffer_mirror_granularity(void);
+
+/**
+ * @brief Map a mirrored buffer.
+ *
+ * Uses memfd_create() and two MAP_FIXED mappings of the same file over a
+ * reserved 2 * size address range. Only available on Linux.
+ *
+ * @param mirror Pointer to the mirror handle.
+ * @param size   Size of the buffer in bytes (multiple of the granularity).
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the mapping
+ * could not be created).
+ */
+ring_buffer_status_t ring_buffer_mirror_init(ring_buffer_mirror_t *mirror,
+                                             size_t size);
+
+/**
+ * @brief Unmap a mirrored buffer.
+ *
+ * @param mirror Pointer to the mirror handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_mirror_destroy(ring_buffer_mirror_t *mirror);
+
+#endif /* RING_BUFFER_MIRROR_H_ */
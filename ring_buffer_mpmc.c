@@ -0,0 +1,459 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_mpmc.c                                                   *
+ * Description:                                                               *
+ *     Implementation of the lock-free multi-producer/multi-consumer          *
+ *     ring buffer functions.                                                 *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "ring_buffer_mpmc.h"
+#include "ring_buffer_internal.h"
+#include <string.h>
+#include <stdint.h>
+
+/* Inline function to get the start of the slot for a position */
+static inline uint8_t *ring_buffer_mpmc_slot(const ring_buffer_mpmc_t *handle,
+                                             ring_buffer_mpmc_seq_t pos)
+{
+    return &handle->buffer[(size_t)(pos & handle->mask) * handle->slot_size];
+}
+
+/* Inline function to get the sequence counter of a slot */
+static inline _Atomic ring_buffer_mpmc_seq_t *
+ring_buffer_mpmc_seq(const ring_buffer_mpmc_t *handle,
+                     ring_buffer_mpmc_seq_t pos)
+{
+    return (_Atomic ring_buffer_mpmc_seq_t *)(void *)ring_buffer_mpmc_slot(
+        handle, pos);
+}
+
+/* Inline function to get the element storage of a slot */
+static inline uint8_t *ring_buffer_mpmc_data(const ring_buffer_mpmc_t *handle,
+                                             ring_buffer_mpmc_seq_t pos)
+{
+    return ring_buffer_mpmc_slot(handle, pos) + sizeof(ring_buffer_mpmc_seq_t);
+}
+
+/* Initialize the MPMC ring buffer */
+ring_buffer_status_t ring_buffer_mpmc_init(ring_buffer_mpmc_t *handle,
+                                           size_t element_size,
+                                           ring_buffer_index_t length,
+                                           uint8_t *buffer)
+{
+    if ((handle == NULL) || (buffer == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((element_size == 0U) || (length < 2U) ||
+        ((length & (length - 1U)) != 0U) ||
+        (((uintptr_t)buffer % _Alignof(ring_buffer_mpmc_seq_t)) != 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_mpmc_t));
+
+    handle->element_size = element_size;
+    handle->slot_size = RING_BUFFER_MPMC_SLOT_SIZE(element_size);
+    handle->length = length;
+    handle->mask = length - 1U;
+    handle->buffer = buffer;
+
+    /* Slot i is first free for the producer that claims position i */
+    for (ring_buffer_index_t i = 0U; i < length; i++)
+    {
+        atomic_init(ring_buffer_mpmc_seq(handle, i), i);
+    }
+
+    atomic_init(&handle->head, 0U);
+    atomic_init(&handle->tail, 0U);
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+}
+
+/* Destroy the MPMC ring buffer */
+ring_buffer_status_t ring_buffer_mpmc_destroy(ring_buffer_mpmc_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_mpmc_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Claim the head position and store an element; no validation or stats */
+static ring_buffer_status_t
+ring_buffer_mpmc_enqueue(ring_buffer_mpmc_t *handle, const void *element)
+{
+    ring_buffer_mpmc_seq_t pos =
+        atomic_load_explicit(&handle->head, memory_order_relaxed);
+    _Atomic ring_buffer_mpmc_seq_t *seq;
+
+    for (;;)
+    {
+        seq = ring_buffer_mpmc_seq(handle, pos);
+
+        ring_buffer_mpmc_seq_t current =
+            atomic_load_explicit(seq, memory_order_acquire);
+        ring_buffer_mpmc_diff_t diff =
+            (ring_buffer_mpmc_diff_t)(current - pos);
+
+        if (diff == 0)
+        {
+            /* Slot is free for this lap: try to claim the position */
+            if (atomic_compare_exchange_weak_explicit(&handle->head, &pos,
+                                                      pos + 1U,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* Slot still holds an element from the previous lap */
+            return RING_BUFFER_FULL;
+        }
+        else
+        {
+            /* Another producer claimed this position, catch up */
+            pos = atomic_load_explicit(&handle->head, memory_order_relaxed);
+        }
+    }
+
+    (void)memcpy(ring_buffer_mpmc_data(handle, pos), element,
+                 handle->element_size);
+
+    /* Publish the element to the consumers */
+    atomic_store_explicit(seq, pos + 1U, memory_order_release);
+
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_mpmc_seq_t used =
+        (pos + 1U) - atomic_load_explicit(&handle->tail, memory_order_relaxed);
+
+    /* Consumers may already have moved past pos */
+    if ((ring_buffer_mpmc_diff_t)used > 0)
+    {
+        ring_buffer_stat_watermark(&handle->producer_stats.high_watermark,
+                                   (ring_buffer_index_t)used);
+    }
+#endif
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element into the MPMC ring buffer */
+ring_buffer_status_t ring_buffer_mpmc_push(ring_buffer_mpmc_t *handle,
+                                           const void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_status_t status = ring_buffer_mpmc_enqueue(handle, element);
+
+    if (status == RING_BUFFER_OK)
+    {
+        RING_BUFFER_STAT_SHARED_ADD(handle->producer_stats.pushes, 1U);
+    }
+    else
+    {
+        RING_BUFFER_STAT_SHARED_ADD(handle->producer_stats.full_rejects, 1U);
+    }
+
+    return status;
+}
+
+/*
+ * Claim the oldest element for a consumer. Returns NULL when the buffer is
+ * empty; otherwise the slot is owned by the caller until its sequence
+ * counter is advanced to *pos + length.
+ */
+static _Atomic ring_buffer_mpmc_seq_t *
+ring_buffer_mpmc_claim_tail(ring_buffer_mpmc_t *handle,
+                            ring_buffer_mpmc_seq_t *claimed)
+{
+    ring_buffer_mpmc_seq_t pos =
+        atomic_load_explicit(&handle->tail, memory_order_relaxed);
+    _Atomic ring_buffer_mpmc_seq_t *seq;
+
+    for (;;)
+    {
+        seq = ring_buffer_mpmc_seq(handle, pos);
+
+        ring_buffer_mpmc_seq_t current =
+            atomic_load_explicit(seq, memory_order_acquire);
+        ring_buffer_mpmc_diff_t diff =
+            (ring_buffer_mpmc_diff_t)(current - (pos + 1U));
+
+        if (diff == 0)
+        {
+            /* Slot is filled for this lap: try to claim the position */
+            if (atomic_compare_exchange_weak_explicit(&handle->tail, &pos,
+                                                      pos + 1U,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* Slot has not been written for this lap yet */
+            return NULL;
+        }
+        else
+        {
+            /* Another consumer claimed this position, catch up */
+            pos = atomic_load_explicit(&handle->tail, memory_order_relaxed);
+        }
+    }
+
+    *claimed = pos;
+
+    return seq;
+}
+
+/* Pop an element from the MPMC ring buffer */
+ring_buffer_status_t ring_buffer_mpmc_pop(ring_buffer_mpmc_t *handle,
+                                          void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_mpmc_seq_t pos;
+    _Atomic ring_buffer_mpmc_seq_t *seq =
+        ring_buffer_mpmc_claim_tail(handle, &pos);
+
+    if (seq == NULL)
+    {
+        RING_BUFFER_STAT_SHARED_ADD(handle->consumer_stats.empty_rejects, 1U);
+        return RING_BUFFER_EMPTY;
+    }
+
+    (void)memcpy(element, ring_buffer_mpmc_data(handle, pos),
+                 handle->element_size);
+
+    /* Hand the slot to the producer of the next lap */
+    atomic_store_explicit(seq, pos + handle->length, memory_order_release);
+    RING_BUFFER_STAT_SHARED_ADD(handle->consumer_stats.pops, 1U);
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element, dropping the oldest ones while the buffer is full */
+ring_buffer_status_t
+ring_buffer_mpmc_push_overwrite(ring_buffer_mpmc_t *handle, const void *element,
+                                ring_buffer_index_t *dropped)
+{
+    if ((handle == NULL) || (element == NULL) || (dropped == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *dropped = 0U;
+
+    ring_buffer_status_t status = ring_buffer_mpmc_enqueue(handle, element);
+
+    while (status == RING_BUFFER_FULL)
+    {
+        ring_buffer_mpmc_seq_t pos;
+        _Atomic ring_buffer_mpmc_seq_t *seq =
+            ring_buffer_mpmc_claim_tail(handle, &pos);
+
+        /*
+         * Discard the oldest element exactly like a consumer would, so a
+         * concurrent pop can never observe a slot that is being rewritten.
+         */
+        if (seq != NULL)
+        {
+            atomic_store_explicit(seq, pos + handle->length,
+                                  memory_order_release);
+            (*dropped)++;
+        }
+
+        status = ring_buffer_mpmc_enqueue(handle, element);
+    }
+
+    RING_BUFFER_STAT_SHARED_ADD(handle->producer_stats.pushes, 1U);
+    RING_BUFFER_STAT_SHARED_ADD(handle->producer_stats.overwrites, *dropped);
+
+    return status;
+}
+
+/* Drop every element currently in the MPMC ring buffer */
+ring_buffer_status_t ring_buffer_mpmc_drain(ring_buffer_mpmc_t *handle,
+                                            ring_buffer_index_t *drained)
+{
+    if ((handle == NULL) || (drained == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_mpmc_seq_t pos;
+    _Atomic ring_buffer_mpmc_seq_t *seq;
+
+    *drained = 0U;
+
+    while ((seq = ring_buffer_mpmc_claim_tail(handle, &pos)) != NULL)
+    {
+        /* Hand the slot to the producer of the next lap */
+        atomic_store_explicit(seq, pos + handle->length, memory_order_release);
+        (*drained)++;
+    }
+
+    RING_BUFFER_STAT_SHARED_ADD(handle->consumer_stats.pops, *drained);
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the current state of the MPMC ring buffer */
+ring_buffer_status_t ring_buffer_mpmc_state(const ring_buffer_mpmc_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_mpmc_seq_t tail =
+        atomic_load_explicit(&handle->tail, memory_order_acquire);
+    ring_buffer_mpmc_seq_t head =
+        atomic_load_explicit(&handle->head, memory_order_acquire);
+    ring_buffer_mpmc_seq_t count = head - tail;
+
+    /* tail is read first, so a stale tail can only overstate the count */
+    if (count == 0U)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+    else if (count >= handle->length)
+    {
+        return RING_BUFFER_FULL;
+    }
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the number of elements in the MPMC ring buffer */
+ring_buffer_status_t ring_buffer_mpmc_size(const ring_buffer_mpmc_t *handle,
+                                           ring_buffer_index_t *size)
+{
+    if ((handle == NULL) || (size == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_mpmc_seq_t tail =
+        atomic_load_explicit(&handle->tail, memory_order_acquire);
+    ring_buffer_mpmc_seq_t head =
+        atomic_load_explicit(&handle->head, memory_order_acquire);
+    ring_buffer_mpmc_seq_t count = head - tail;
+
+    /* Claimed but unpublished slots are counted as used */
+    *size = (count > handle->length) ? handle->length
+                                     : (ring_buffer_index_t)count;
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the number of elements the MPMC ring buffer can hold */
+ring_buffer_status_t
+ring_buffer_mpmc_capacity(const ring_buffer_mpmc_t *handle,
+                          ring_buffer_index_t *capacity)
+{
+    if ((handle == NULL) || (capacity == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *capacity = handle->length;
+
+    return RING_BUFFER_OK;
+}
+
+/* Take a snapshot of the MPMC ring buffer counters */
+ring_buffer_status_t ring_buffer_mpmc_stats(const ring_buffer_mpmc_t *handle,
+                                            ring_buffer_stats_t *stats)
+{
+    if ((handle == NULL) || (stats == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_stats_read(&handle->producer_stats, &handle->consumer_stats,
+                           stats);
+
+    return RING_BUFFER_OK;
+#else
+    (void)memset(stats, 0, sizeof(ring_buffer_stats_t));
+
+    return RING_BUFFER_FAIL;
+#endif
+}
@@ -0,0 +1,226 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_mpmc.h                                                   *
+ * Description:                                                               *
+ *     Header file defining a lock-free multi-producer/multi-consumer         *
+ *     ring buffer with per-slot sequence numbers.                            *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_MPMC_H_
+#define RING_BUFFER_MPMC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+
+/*
+ * Width in bits of head, tail and the per-slot sequence counters. 64 where
+ * such atomics are lock-free, so that a thread preempted between reading a
+ * position and its CAS can never see the position come round again (ABA);
+ * it can be lowered to save slot space, but not below
+ * RING_BUFFER_INDEX_BITS.
+ */
+#ifndef RING_BUFFER_MPMC_SEQ_BITS
+#if (ATOMIC_LLONG_LOCK_FREE == 2) || (RING_BUFFER_INDEX_BITS == 64)
+#define RING_BUFFER_MPMC_SEQ_BITS 64
+#else
+#define RING_BUFFER_MPMC_SEQ_BITS 32
+#endif
+#endif
+
+#if RING_BUFFER_MPMC_SEQ_BITS < RING_BUFFER_INDEX_BITS
+#error "RING_BUFFER_MPMC_SEQ_BITS must be at least RING_BUFFER_INDEX_BITS"
+#elif RING_BUFFER_MPMC_SEQ_BITS == 16
+typedef uint16_t ring_buffer_mpmc_seq_t;
+typedef int16_t ring_buffer_mpmc_diff_t;
+#elif RING_BUFFER_MPMC_SEQ_BITS == 32
+typedef uint32_t ring_buffer_mpmc_seq_t;
+typedef int32_t ring_buffer_mpmc_diff_t;
+#elif RING_BUFFER_MPMC_SEQ_BITS == 64
+typedef uint64_t ring_buffer_mpmc_seq_t;
+typedef int64_t ring_buffer_mpmc_diff_t;
+#else
+#error "RING_BUFFER_MPMC_SEQ_BITS must be 16, 32 or 64"
+#endif
+
+/* Size in bytes of one slot (sequence counter followed by the element) */
+#define RING_BUFFER_MPMC_SLOT_SIZE(element_size)                               \
+    ((((sizeof(ring_buffer_mpmc_seq_t) + (size_t)(element_size)) +             \
+       sizeof(ring_buffer_mpmc_seq_t) - 1U) /                                  \
+      sizeof(ring_buffer_mpmc_seq_t)) *                                        \
+     sizeof(ring_buffer_mpmc_seq_t))
+
+/* Size in bytes of the buffer memory needed by ring_buffer_mpmc_init() */
+#define RING_BUFFER_MPMC_BUFFER_SIZE(element_size, length)                     \
+    (RING_BUFFER_MPMC_SLOT_SIZE(element_size) * (size_t)(length))
+
+/*
+ * Structure representing the MPMC ring buffer.
+ *
+ * Every slot carries a sequence counter that tells producers and consumers
+ * whose turn it is (bounded queue after D. Vyukov). Producers claim a slot
+ * by moving head forward with a CAS, consumers do the same with tail, and
+ * the sequence store publishes the slot to the other side. head and tail
+ * are free-running counters on their own cache lines.
+ */
+typedef struct
+{
+    uint8_t *buffer;          /* Pointer to the slot memory */
+    ring_buffer_index_t length; /* Number of slots (power of two) */
+    ring_buffer_index_t mask; /* length - 1 */
+    size_t element_size;      /* Size of each element in bytes */
+    size_t slot_size;         /* Size of each slot in bytes */
+    uint8_t init_flag;        /* Initialization flag */
+
+    /* Producer-shared block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic ring_buffer_mpmc_seq_t head; /* Next position to enqueue */
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_producer_stats_t producer_stats; /* Push-side counters */
+#endif
+
+    /* Consumer-shared block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic ring_buffer_mpmc_seq_t tail; /* Next position to dequeue */
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_consumer_stats_t consumer_stats; /* Pop-side counters */
+#endif
+} ring_buffer_mpmc_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Initialize the MPMC ring buffer.
+ *
+ * @param handle        Pointer to the ring buffer handle.
+ * @param element_size  Size of each element in bytes.
+ * @param length        Number of elements in the buffer (power of two).
+ * @param buffer        Pointer to RING_BUFFER_MPMC_BUFFER_SIZE(element_size,
+ *                      length) bytes, aligned for ring_buffer_mpmc_seq_t.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_mpmc_init(ring_buffer_mpmc_t *handle,
+                                           size_t element_size,
+                                           ring_buffer_index_t length,
+                                           uint8_t *buffer);
+
+/**
+ * @brief Destroy the MPMC ring buffer.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_mpmc_destroy(ring_buffer_mpmc_t *handle);
+
+/**
+ * @brief Push an element into the MPMC ring buffer.
+ *
+ * Safe to call from any number of producer threads.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_mpmc_push(ring_buffer_mpmc_t *handle,
+                                           const void *element);
+
+/**
+ * @brief Pop an element from the MPMC ring buffer.
+ *
+ * Safe to call from any number of consumer threads.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param element Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_mpmc_pop(ring_buffer_mpmc_t *handle,
+                                          void *element);
+
+/**
+ * @brief Push an element, dropping the oldest ones while the ring is full.
+ *
+ * Safe against concurrent producers and consumers: old elements are
+ * discarded through the same CAS on tail that consumers use, so a reader
+ * never sees a slot being overwritten. *dropped can exceed one when other
+ * producers refill the freed slot first.
+ *
+ * @param handle  Pointer to the ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @param dropped Pointer where the number of dropped elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_mpmc_push_overwrite(ring_buffer_mpmc_t *handle, const void *element,
+                                ring_buffer_index_t *dropped);
+
+/**
+ * @brief Drop every element currently in the MPMC ring buffer.
+ *
+ * Consumer side and safe against other producers and consumers: each
+ * element is discarded through the same tail CAS a pop uses but without
+ * copying it out. Stops as soon as the ring looks empty, so elements pushed
+ * concurrently may be dropped too.
+ *
+ * @param handle  Pointer to the ring buffer handle.
+ * @param drained Pointer where the number of dropped elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_mpmc_drain(ring_buffer_mpmc_t *handle,
+                                            ring_buffer_index_t *drained);
+
+/**
+ * @brief Get the current state of the MPMC ring buffer.
+ *
+ * The result is a snapshot and may be stale by the time it is returned.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY,
+ * RING_BUFFER_FULL, or RING_BUFFER_OK).
+ */
+ring_buffer_status_t ring_buffer_mpmc_state(const ring_buffer_mpmc_t *handle);
+
+/**
+ * @brief Get the number of elements in the MPMC ring buffer.
+ *
+ * The result is a snapshot and may be stale by the time it is returned.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param size   Pointer where the number of elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_mpmc_size(const ring_buffer_mpmc_t *handle,
+                                           ring_buffer_index_t *size);
+
+/**
+ * @brief Get the number of elements the MPMC ring buffer can hold.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param capacity Pointer where the capacity is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_mpmc_capacity(const ring_buffer_mpmc_t *handle,
+                          ring_buffer_index_t *capacity);
+
+/**
+ * @brief Take a snapshot of the MPMC ring buffer counters.
+ *
+ * Same contract as ring_buffer_stats(). Producers share one set of
+ * counters next to head and consumers one next to tail, both updated
+ * with relaxed atomic adds.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param stats  Pointer where the counters are stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_mpmc_stats(const ring_buffer_mpmc_t *handle,
+                                            ring_buffer_stats_t *stats);
+
+#endif /* RING_BUFFER_MPMC_H_ */
@@ -0,0 +1,327 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_notify.c                                                 *
+ * Description:                                                               *
+ *     Implementation of the file-descriptor readiness notification for the   *
+ *     SPSC ring buffer.                                                      *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ring_buffer_notify.h"
+#include <string.h>
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define RING_BUFFER_NOTIFY_POSIX 1
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#ifdef RING_BUFFER_NOTIFY_POSIX
+/* Create a non-blocking descriptor pair, returns 0 on success */
+static int ring_buffer_notify_open(int fds[2])
+{
+#ifdef __linux__
+    int fd = eventfd(0U, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    fds[0] = fd;
+    fds[1] = fd;
+#else
+    if (pipe(fds) != 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0U; i < 2U; i++)
+    {
+        if ((fcntl(fds[i], F_SETFL, O_NONBLOCK) != 0) ||
+            (fcntl(fds[i], F_SETFD, FD_CLOEXEC) != 0))
+        {
+            (void)close(fds[0]);
+            (void)close(fds[1]);
+            return -1;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+/* Close a descriptor pair */
+static void ring_buffer_notify_close(const int fds[2])
+{
+    (void)close(fds[0]);
+
+    if (fds[1] != fds[0])
+    {
+        (void)close(fds[1]);
+    }
+}
+#endif
+
+/* Make the polled descriptor readable */
+static void ring_buffer_notify_signal(const int fds[2])
+{
+#ifdef RING_BUFFER_NOTIFY_POSIX
+#ifdef __linux__
+    uint64_t value = 1U;
+#else
+    uint8_t value = 1U;
+#endif
+
+    /* A full pipe or counter is already readable: nothing to do */
+    ssize_t written = write(fds[1], &value, sizeof(value));
+
+    (void)written;
+#else
+    (void)fds;
+#endif
+}
+
+/* Consume pending signals so the polled descriptor is no longer readable */
+static void ring_buffer_notify_reset(const int fds[2])
+{
+#ifdef RING_BUFFER_NOTIFY_POSIX
+    uint8_t pending[64];
+
+    /* An eventfd is reset by one read; a pipe may need several */
+    while (read(fds[0], pending, sizeof(pending)) > 0)
+    {
+        if (fds[1] == fds[0])
+        {
+            break;
+        }
+    }
+#else
+    (void)fds;
+#endif
+}
+
+/* Signal the other side, but only if it armed its flag */
+static void ring_buffer_notify_wake(_Atomic uint32_t *armed, const int fds[2])
+{
+    /* Pairs with the fence after the other side arms its flag */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if ((atomic_load_explicit(armed, memory_order_relaxed) != 0U) &&
+        (atomic_exchange_explicit(armed, 0U, memory_order_relaxed) != 0U))
+    {
+        ring_buffer_notify_signal(fds);
+    }
+}
+
+/* Attach readiness file descriptors to an SPSC ring buffer */
+ring_buffer_status_t ring_buffer_notifier_init(ring_buffer_notifier_t *notifier,
+                                               ring_buffer_spsc_t *ring)
+{
+    if ((notifier == NULL) || (ring == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (notifier->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if (ring->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(notifier, 0, sizeof(ring_buffer_notifier_t));
+
+#ifdef RING_BUFFER_NOTIFY_POSIX
+    if (ring_buffer_notify_open(notifier->readable) != 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    if (ring_buffer_notify_open(notifier->writable) != 0)
+    {
+        ring_buffer_notify_close(notifier->readable);
+        return RING_BUFFER_FAIL;
+    }
+
+    notifier->ring = ring;
+    atomic_init(&notifier->consumer_armed, 0U);
+    atomic_init(&notifier->producer_armed, 0U);
+    notifier->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+#else
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Close the readiness file descriptors */
+ring_buffer_status_t
+ring_buffer_notifier_destroy(ring_buffer_notifier_t *notifier)
+{
+    if (notifier == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (notifier->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef RING_BUFFER_NOTIFY_POSIX
+    ring_buffer_notify_close(notifier->readable);
+    ring_buffer_notify_close(notifier->writable);
+#endif
+
+    /* Clear the handle structure */
+    (void)memset(notifier, 0, sizeof(ring_buffer_notifier_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the descriptor the consumer polls for input */
+ring_buffer_status_t
+ring_buffer_notifier_readable_fd(const ring_buffer_notifier_t *notifier,
+                                 int *fd)
+{
+    if ((notifier == NULL) || (fd == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (notifier->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *fd = notifier->readable[0];
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the descriptor the producer polls for input */
+ring_buffer_status_t
+ring_buffer_notifier_writable_fd(const ring_buffer_notifier_t *notifier,
+                                 int *fd)
+{
+    if ((notifier == NULL) || (fd == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (notifier->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *fd = notifier->writable[0];
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element and signal the consumer if it was waiting */
+ring_buffer_status_t ring_buffer_push_notify(ring_buffer_notifier_t *notifier,
+                                             const void *element)
+{
+    if ((notifier == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (notifier->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_spsc_push(notifier->ring, element);
+
+    if (status == RING_BUFFER_FULL)
+    {
+        /* Reset before arming so that only signals sent after it count */
+        ring_buffer_notify_reset(notifier->writable);
+        atomic_store_explicit(&notifier->producer_armed, 1U,
+                              memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        /* The consumer may have popped before it could see the flag */
+        status = ring_buffer_spsc_push(notifier->ring, element);
+
+        if (status != RING_BUFFER_OK)
+        {
+            return status;
+        }
+
+        atomic_store_explicit(&notifier->producer_armed, 0U,
+                              memory_order_relaxed);
+    }
+
+    if (status == RING_BUFFER_OK)
+    {
+        ring_buffer_notify_wake(&notifier->consumer_armed,
+                                notifier->readable);
+    }
+
+    return status;
+}
+
+/* Pop an element and signal the producer if it was waiting */
+ring_buffer_status_t ring_buffer_pop_notify(ring_buffer_notifier_t *notifier,
+                                            void *element)
+{
+    if ((notifier == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (notifier->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_status_t status = ring_buffer_spsc_pop(notifier->ring, element);
+
+    if (status == RING_BUFFER_EMPTY)
+    {
+        /* Reset before arming so that only signals sent after it count */
+        ring_buffer_notify_reset(notifier->readable);
+        atomic_store_explicit(&notifier->consumer_armed, 1U,
+                              memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        /* The producer may have pushed before it could see the flag */
+        status = ring_buffer_spsc_pop(notifier->ring, element);
+
+        if (status != RING_BUFFER_OK)
+        {
+            return status;
+        }
+
+        atomic_store_explicit(&notifier->consumer_armed, 0U,
+                              memory_order_relaxed);
+    }
+
+    if (status == RING_BUFFER_OK)
+    {
+        ring_buffer_notify_wake(&notifier->producer_armed,
+                                notifier->writable);
+    }
+
+    return status;
+}
@@ -0,0 +1,127 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_notify.h                                                 *
+ * Description:                                                               *
+ *     Header file defining file-descriptor readiness notification for the    *
+ *     SPSC ring buffer, for use with poll/epoll/io_uring event loops.        *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_NOTIFY_H_
+#define RING_BUFFER_NOTIFY_H_
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+
+/*
+ * Structure attaching readiness file descriptors to an SPSC ring buffer.
+ *
+ * readable becomes readable when the ring goes from empty to non-empty,
+ * writable when it goes from full to not full. They are eventfds on Linux
+ * and non-blocking pipes on other POSIX systems (index 0 is polled, index
+ * 1 written; an eventfd uses the same descriptor for both).
+ *
+ * A side that finds the ring empty (full) arms its flag, then checks
+ * again; the other side only writes to the descriptor when it sees the
+ * flag armed, so there is no system call while data keeps flowing. The
+ * flags are on their own cache lines because each is read on every
+ * operation of the other side.
+ */
+typedef struct
+{
+    ring_buffer_spsc_t *ring; /* Attached ring buffer */
+    int readable[2];          /* Signalled when data arrives */
+    int writable[2];          /* Signalled when space frees up */
+    uint8_t init_flag;        /* Initialization flag */
+
+    /* Written by the consumer, read by every push */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t consumer_armed; /* Consumer is waiting for data */
+
+    /* Written by the producer, read by every pop */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t producer_armed; /* Producer is waiting for space */
+} ring_buffer_notifier_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Attach readiness file descriptors to an SPSC ring buffer.
+ *
+ * @param notifier Pointer to the notifier handle.
+ * @param ring     Pointer to an initialized SPSC ring buffer.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the
+ * descriptors could not be created).
+ */
+ring_buffer_status_t ring_buffer_notifier_init(ring_buffer_notifier_t *notifier,
+                                               ring_buffer_spsc_t *ring);
+
+/**
+ * @brief Close the readiness file descriptors.
+ *
+ * They must have been removed from every event loop first.
+ *
+ * @param notifier Pointer to the notifier handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_notifier_destroy(ring_buffer_notifier_t *notifier);
+
+/**
+ * @brief Get the descriptor the consumer polls for input.
+ *
+ * @param notifier Pointer to the notifier handle.
+ * @param fd       Pointer where the descriptor is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_notifier_readable_fd(const ring_buffer_notifier_t *notifier,
+                                 int *fd);
+
+/**
+ * @brief Get the descriptor the producer polls for input.
+ *
+ * It becomes readable (not writable) when space frees up.
+ *
+ * @param notifier Pointer to the notifier handle.
+ * @param fd       Pointer where the descriptor is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_notifier_writable_fd(const ring_buffer_notifier_t *notifier,
+                                 int *fd);
+
+/**
+ * @brief Push an element and signal the consumer if it was waiting.
+ *
+ * Producer side, never blocks. On RING_BUFFER_FULL the writable descriptor
+ * is reset and armed: poll it, then push again.
+ *
+ * @param notifier Pointer to the notifier handle.
+ * @param element  Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_push_notify(ring_buffer_notifier_t *notifier,
+                                             const void *element);
+
+/**
+ * @brief Pop an element and signal the producer if it was waiting.
+ *
+ * Consumer side, never blocks. On RING_BUFFER_EMPTY the readable
+ * descriptor is reset and armed: poll it, then pop again.
+ *
+ * @param notifier Pointer to the notifier handle.
+ * @param element  Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_pop_notify(ring_buffer_notifier_t *notifier,
+                                            void *element);
+
+#endif /* RING_BUFFER_NOTIFY_H_ */
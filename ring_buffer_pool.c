@@ -0,0 +1,220 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_pool.c                                                   *
+ * Description:                                                               *
+ *     Implementation of the object pool built on a free ring and a ready     *
+ *     ring of pointers.                                                      *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "ring_buffer_pool.h"
+#include <string.h>
+#include <stdint.h>
+
+/* Check that a pointer is the start of one of the pool's objects */
+static int ring_buffer_pool_owns(const ring_buffer_pool_t *handle,
+                                 const void *object)
+{
+    /* A pointer below the objects wraps around to a huge offset */
+    uintptr_t offset = (uintptr_t)object - (uintptr_t)handle->objects;
+
+    return (offset < (handle->object_size * (size_t)handle->count)) &&
+           ((offset % handle->object_size) == 0U);
+}
+
+/* Initialize the object pool and put every object in the free ring */
+ring_buffer_status_t ring_buffer_pool_init(ring_buffer_pool_t *handle,
+                                           void *objects, size_t object_size,
+                                           ring_buffer_index_t count,
+                                           uint8_t *buffer)
+{
+    if ((handle == NULL) || (objects == NULL) || (buffer == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((object_size == 0U) || (count < 2U) ||
+        ((count & (count - 1U)) != 0U) || (object_size > (SIZE_MAX / count)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_pool_t));
+
+    ring_buffer_status_t status =
+        ring_buffer_mpmc_init(&handle->free_ring, sizeof(void *), count,
+                              buffer);
+
+    if (status == RING_BUFFER_OK)
+    {
+        status = ring_buffer_mpmc_init(
+            &handle->ready_ring, sizeof(void *), count,
+            &buffer[RING_BUFFER_MPMC_BUFFER_SIZE(sizeof(void *), count)]);
+    }
+
+    if (status != RING_BUFFER_OK)
+    {
+        (void)memset(handle, 0, sizeof(ring_buffer_pool_t));
+        return status;
+    }
+
+    for (ring_buffer_index_t i = 0U; i < count; i++)
+    {
+        void *object = &((uint8_t *)objects)[(size_t)i * object_size];
+
+        (void)ring_buffer_mpmc_push(&handle->free_ring, &object);
+    }
+
+    handle->objects = objects;
+    handle->object_size = object_size;
+    handle->count = count;
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+}
+
+/* Destroy the object pool */
+ring_buffer_status_t ring_buffer_pool_destroy(ring_buffer_pool_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    (void)ring_buffer_mpmc_destroy(&handle->free_ring);
+    (void)ring_buffer_mpmc_destroy(&handle->ready_ring);
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_pool_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Take a free object to fill */
+ring_buffer_status_t ring_buffer_pool_acquire(ring_buffer_pool_t *handle,
+                                              void **object)
+{
+    if ((handle == NULL) || (object == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    return ring_buffer_mpmc_pop(&handle->free_ring, object);
+}
+
+/* Queue a filled object for the consumers */
+ring_buffer_status_t ring_buffer_pool_submit(ring_buffer_pool_t *handle,
+                                             void *object)
+{
+    if ((handle == NULL) || (object == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (!ring_buffer_pool_owns(handle, object))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    return ring_buffer_mpmc_push(&handle->ready_ring, &object);
+}
+
+/* Take the oldest filled object */
+ring_buffer_status_t ring_buffer_pool_receive(ring_buffer_pool_t *handle,
+                                              void **object)
+{
+    if ((handle == NULL) || (object == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    return ring_buffer_mpmc_pop(&handle->ready_ring, object);
+}
+
+/* Return an object to the free ring */
+ring_buffer_status_t ring_buffer_pool_recycle(ring_buffer_pool_t *handle,
+                                              void *object)
+{
+    if ((handle == NULL) || (object == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (!ring_buffer_pool_owns(handle, object))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    return ring_buffer_mpmc_push(&handle->free_ring, &object);
+}
+
+/* Get the number of objects in the free ring */
+ring_buffer_status_t
+ring_buffer_pool_available(const ring_buffer_pool_t *handle,
+                           ring_buffer_index_t *available)
+{
+    if ((handle == NULL) || (available == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    return ring_buffer_mpmc_size(&handle->free_ring, available);
+}
+
+/* Get the number of submitted objects not yet received */
+ring_buffer_status_t ring_buffer_pool_pending(const ring_buffer_pool_t *handle,
+                                              ring_buffer_index_t *pending)
+{
+    if ((handle == NULL) || (pending == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    return ring_buffer_mpmc_size(&handle->ready_ring, pending);
+}
@@ -0,0 +1,146 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_pool.h                                                   *
+ * Description:                                                               *
+ *     Header file defining an object pool made of a free ring and a ready    *
+ *     ring of pointers, so messages are recycled instead of allocated.       *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_POOL_H_
+#define RING_BUFFER_POOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ring_buffer.h"
+#include "ring_buffer_mpmc.h"
+
+/* Size in bytes of the ring memory needed by ring_buffer_pool_init() */
+#define RING_BUFFER_POOL_BUFFER_SIZE(count)                                    \
+    (2U * RING_BUFFER_MPMC_BUFFER_SIZE(sizeof(void *), (count)))
+
+/*
+ * Structure representing the object pool.
+ *
+ * Every object starts in free_ring. A producer acquires one from it, fills
+ * it and submits it to ready_ring; a consumer receives it from ready_ring,
+ * uses it and recycles it back to free_ring. Only pointers move through
+ * the rings, and both hold every object at once, so a submit or recycle
+ * of an object of this pool never finds its ring full. Both rings are
+ * MPMC, so any number of threads may use the pool at the same time.
+ */
+typedef struct
+{
+    ring_buffer_mpmc_t free_ring;  /* Objects available to producers */
+    ring_buffer_mpmc_t ready_ring; /* Filled objects waiting for consumers */
+    uint8_t *objects;              /* Pointer to the object memory */
+    size_t object_size;            /* Size of each object in bytes */
+    ring_buffer_index_t count;     /* Number of objects */
+    uint8_t init_flag;             /* Initialization flag */
+} ring_buffer_pool_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Initialize the object pool and put every object in the free ring.
+ *
+ * @param handle      Pointer to the pool handle.
+ * @param objects     Pointer to count * object_size bytes of objects.
+ * @param object_size Size of each object in bytes (a multiple of its
+ *                    alignment, so that every object stays aligned).
+ * @param count       Number of objects (power of two).
+ * @param buffer      Pointer to RING_BUFFER_POOL_BUFFER_SIZE(count) bytes,
+ *                    aligned for ring_buffer_mpmc_seq_t.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_pool_init(ring_buffer_pool_t *handle,
+                                           void *objects, size_t object_size,
+                                           ring_buffer_index_t count,
+                                           uint8_t *buffer);
+
+/**
+ * @brief Destroy the object pool.
+ *
+ * No thread may still hold or use one of its objects.
+ *
+ * @param handle Pointer to the pool handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_pool_destroy(ring_buffer_pool_t *handle);
+
+/**
+ * @brief Take a free object to fill (producer side).
+ *
+ * @param handle Pointer to the pool handle.
+ * @param object Pointer where the object pointer is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if every
+ * object is in use).
+ */
+ring_buffer_status_t ring_buffer_pool_acquire(ring_buffer_pool_t *handle,
+                                              void **object);
+
+/**
+ * @brief Queue a filled object for the consumers (producer side).
+ *
+ * @param handle Pointer to the pool handle.
+ * @param object Object obtained from ring_buffer_pool_acquire().
+ * @return ring_buffer_status_t Status code (RING_BUFFER_INVALID_PARAMS if
+ * the object does not belong to the pool).
+ */
+ring_buffer_status_t ring_buffer_pool_submit(ring_buffer_pool_t *handle,
+                                             void *object);
+
+/**
+ * @brief Take the oldest filled object (consumer side).
+ *
+ * @param handle Pointer to the pool handle.
+ * @param object Pointer where the object pointer is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if no object
+ * has been submitted).
+ */
+ring_buffer_status_t ring_buffer_pool_receive(ring_buffer_pool_t *handle,
+                                              void **object);
+
+/**
+ * @brief Return an object to the free ring once it has been used.
+ *
+ * Also returns an acquired object that will not be submitted after all.
+ * Each object must be recycled exactly once: a second recycle is not
+ * detected.
+ *
+ * @param handle Pointer to the pool handle.
+ * @param object Object obtained from ring_buffer_pool_receive() or
+ *               ring_buffer_pool_acquire().
+ * @return ring_buffer_status_t Status code (RING_BUFFER_INVALID_PARAMS if
+ * the object does not belong to the pool).
+ */
+ring_buffer_status_t ring_buffer_pool_recycle(ring_buffer_pool_t *handle,
+                                              void *object);
+
+/**
+ * @brief Get the number of objects in the free ring.
+ *
+ * @param handle    Pointer to the pool handle.
+ * @param available Pointer where the number of free objects is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_pool_available(const ring_buffer_pool_t *handle,
+                           ring_buffer_index_t *available);
+
+/**
+ * @brief Get the number of submitted objects not yet received.
+ *
+ * @param handle  Pointer to the pool handle.
+ * @param pending Pointer where the number of queued objects is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_pool_pending(const ring_buffer_pool_t *handle,
+                                              ring_buffer_index_t *pending);
+
+#endif /* RING_BUFFER_POOL_H_ */
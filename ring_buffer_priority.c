@@ -0,0 +1,331 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_priority.c                                               *
+ * Description:                                                               *
+ *     Implementation of the priority queue made of several ring buffers.     *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "ring_buffer_priority.h"
+#include "ring_buffer_inline.h"
+#include <string.h>
+#include <stdint.h>
+
+/* Index of the lowest set bit (the highest non-empty level), mask != 0 */
+static inline uint32_t ring_buffer_priority_first(uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(mask);
+#else
+    uint32_t level = 0U;
+
+    while ((mask & 1U) == 0U)
+    {
+        mask >>= 1U;
+        level++;
+    }
+
+    return level;
+#endif
+}
+
+/* Clear the level's bit once its ring has been emptied */
+static inline void ring_buffer_priority_update(ring_buffer_priority_t *handle,
+                                               uint32_t priority)
+{
+    if (ring_buffer_count(&handle->rings[priority]) == 0U)
+    {
+        handle->non_empty &= ~(1U << priority);
+    }
+}
+
+/* Initialize the priority queue over initialized ring buffers */
+ring_buffer_status_t ring_buffer_priority_init(ring_buffer_priority_t *handle,
+                                               ring_buffer_t *rings,
+                                               uint32_t count)
+{
+    if ((handle == NULL) || (rings == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((count == 0U) || (count > RING_BUFFER_PRIORITY_MAX))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    uint32_t non_empty = 0U;
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        if (rings[i].init_flag != RING_BUFFER_INITIALIZE_MASK)
+        {
+            return RING_BUFFER_NOT_INITIALIZED;
+        }
+
+        if (rings[i].element_size != rings[0].element_size)
+        {
+            return RING_BUFFER_INVALID_PARAMS;
+        }
+
+        if (ring_buffer_count(&rings[i]) != 0U)
+        {
+            non_empty |= 1U << i;
+        }
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_priority_t));
+
+    handle->rings = rings;
+    handle->count = count;
+    handle->non_empty = non_empty;
+    handle->element_size = rings[0].element_size;
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+}
+
+/* Destroy the priority queue */
+ring_buffer_status_t
+ring_buffer_priority_destroy(ring_buffer_priority_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_priority_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element at a priority level */
+ring_buffer_status_t ring_buffer_priority_push(ring_buffer_priority_t *handle,
+                                               uint32_t priority,
+                                               const void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (priority >= handle->count)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_push_unchecked(&handle->rings[priority], element);
+
+    if (status == RING_BUFFER_OK)
+    {
+        handle->non_empty |= 1U << priority;
+    }
+
+    return status;
+}
+
+/* Push up to count elements at a priority level */
+ring_buffer_status_t
+ring_buffer_priority_push_n(ring_buffer_priority_t *handle, uint32_t priority,
+                            const void *elements, ring_buffer_index_t count,
+                            ring_buffer_index_t *pushed)
+{
+    if ((handle == NULL) || (elements == NULL) || (pushed == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (priority >= handle->count)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_status_t status = ring_buffer_push_n(&handle->rings[priority],
+                                                     elements, count, pushed);
+
+    if (*pushed != 0U)
+    {
+        handle->non_empty |= 1U << priority;
+    }
+
+    return status;
+}
+
+/* Pop the oldest element of the highest non-empty priority level */
+ring_buffer_status_t ring_buffer_priority_pop(ring_buffer_priority_t *handle,
+                                              void *element,
+                                              uint32_t *priority)
+{
+    if ((handle == NULL) || (element == NULL) || (priority == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (handle->non_empty == 0U)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+
+    uint32_t level = ring_buffer_priority_first(handle->non_empty);
+    ring_buffer_status_t status =
+        ring_buffer_pop_unchecked(&handle->rings[level], element);
+
+    if (status == RING_BUFFER_OK)
+    {
+        ring_buffer_priority_update(handle, level);
+        *priority = level;
+    }
+
+    return status;
+}
+
+/* Pop up to count elements from the highest non-empty level */
+ring_buffer_status_t ring_buffer_priority_pop_n(ring_buffer_priority_t *handle,
+                                                void *elements,
+                                                ring_buffer_index_t count,
+                                                ring_buffer_index_t *popped,
+                                                uint32_t *priority)
+{
+    if ((handle == NULL) || (elements == NULL) || (popped == NULL) ||
+        (priority == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (handle->non_empty == 0U)
+    {
+        *popped = 0U;
+        return RING_BUFFER_EMPTY;
+    }
+
+    uint32_t level = ring_buffer_priority_first(handle->non_empty);
+    ring_buffer_status_t status =
+        ring_buffer_pop_n(&handle->rings[level], elements, count, popped);
+
+    if (status == RING_BUFFER_OK)
+    {
+        ring_buffer_priority_update(handle, level);
+        *priority = level;
+    }
+
+    return status;
+}
+
+/* Pop up to count elements from one priority level */
+ring_buffer_status_t
+ring_buffer_priority_pop_level_n(ring_buffer_priority_t *handle,
+                                 uint32_t priority, void *elements,
+                                 ring_buffer_index_t count,
+                                 ring_buffer_index_t *popped)
+{
+    if ((handle == NULL) || (elements == NULL) || (popped == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (priority >= handle->count)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_pop_n(&handle->rings[priority], elements, count, popped);
+
+    if (status == RING_BUFFER_OK)
+    {
+        ring_buffer_priority_update(handle, priority);
+    }
+
+    return status;
+}
+
+/* Get the state of the priority queue in constant time */
+ring_buffer_status_t
+ring_buffer_priority_state(const ring_buffer_priority_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    return (handle->non_empty == 0U) ? RING_BUFFER_EMPTY : RING_BUFFER_OK;
+}
+
+/* Get the number of elements in all levels */
+ring_buffer_status_t
+ring_buffer_priority_size(const ring_buffer_priority_t *handle, uint64_t *size)
+{
+    if ((handle == NULL) || (size == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    uint64_t total = 0U;
+    uint32_t mask = handle->non_empty;
+
+    /* Only the non-empty levels can contribute */
+    while (mask != 0U)
+    {
+        uint32_t level = ring_buffer_priority_first(mask);
+
+        total += ring_buffer_count(&handle->rings[level]);
+        mask &= mask - 1U;
+    }
+
+    *size = total;
+
+    return RING_BUFFER_OK;
+}
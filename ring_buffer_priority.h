@@ -0,0 +1,173 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_priority.h                                               *
+ * Description:                                                               *
+ *     Header file defining a priority queue made of several ring buffers,    *
+ *     drained highest priority first behind a single pop API.                *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_PRIORITY_H_
+#define RING_BUFFER_PRIORITY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ring_buffer.h"
+
+/* Maximum number of priority levels (one bit each in the non-empty mask) */
+#define RING_BUFFER_PRIORITY_MAX 32U
+
+/*
+ * Structure representing the priority queue.
+ *
+ * Level 0 is the highest priority. Each level is a regular ring buffer set
+ * up by the caller with its own capacity, so a burst of low-priority
+ * elements can fill its own ring without delaying the others. Bit i of
+ * non_empty is set while level i holds elements, so finding the level to
+ * pop from is a single bit scan. Like ring_buffer_t, the queue is not
+ * thread-safe by itself: serialize access with a mutex if it is shared.
+ */
+typedef struct
+{
+    ring_buffer_t *rings; /* One ring per level, level 0 first */
+    uint32_t count;       /* Number of levels */
+    uint32_t non_empty;   /* Bit i set while level i holds elements */
+    size_t element_size;  /* Size of each element in bytes */
+    uint8_t init_flag;    /* Initialization flag */
+} ring_buffer_priority_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Initialize the priority queue over initialized ring buffers.
+ *
+ * The rings may have different lengths but must share the element size.
+ * Elements they already hold are kept. From now on they must only be
+ * accessed through the ring_buffer_priority_*() functions.
+ *
+ * @param handle Pointer to the priority queue handle.
+ * @param rings  Pointer to count initialized rings, highest priority first.
+ * @param count  Number of levels (1 to RING_BUFFER_PRIORITY_MAX).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_priority_init(ring_buffer_priority_t *handle,
+                                               ring_buffer_t *rings,
+                                               uint32_t count);
+
+/**
+ * @brief Destroy the priority queue.
+ *
+ * The rings themselves are left initialized and owned by the caller.
+ *
+ * @param handle Pointer to the priority queue handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_priority_destroy(ring_buffer_priority_t *handle);
+
+/**
+ * @brief Push an element at a priority level.
+ *
+ * @param handle   Pointer to the priority queue handle.
+ * @param priority Level to push to (0 is the highest).
+ * @param element  Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if that
+ * level is full).
+ */
+ring_buffer_status_t ring_buffer_priority_push(ring_buffer_priority_t *handle,
+                                               uint32_t priority,
+                                               const void *element);
+
+/**
+ * @brief Push up to count elements at a priority level.
+ *
+ * @param handle   Pointer to the priority queue handle.
+ * @param priority Level to push to (0 is the highest).
+ * @param elements Pointer to count contiguous elements.
+ * @param count    Number of elements to push.
+ * @param pushed   Pointer where the number of elements pushed is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if no element
+ * could be pushed).
+ */
+ring_buffer_status_t
+ring_buffer_priority_push_n(ring_buffer_priority_t *handle, uint32_t priority,
+                            const void *elements, ring_buffer_index_t count,
+                            ring_buffer_index_t *pushed);
+
+/**
+ * @brief Pop the oldest element of the highest non-empty priority level.
+ *
+ * @param handle   Pointer to the priority queue handle.
+ * @param element  Pointer where the popped element will be stored.
+ * @param priority Pointer where the level it came from is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if every
+ * level is empty).
+ */
+ring_buffer_status_t ring_buffer_priority_pop(ring_buffer_priority_t *handle,
+                                              void *element,
+                                              uint32_t *priority);
+
+/**
+ * @brief Pop up to count elements from the highest non-empty level.
+ *
+ * The batch never mixes levels: it stops when that level runs out, so a
+ * higher-priority element pushed meanwhile is not held behind lower ones.
+ *
+ * @param handle   Pointer to the priority queue handle.
+ * @param elements Pointer where up to count elements will be stored.
+ * @param count    Maximum number of elements to pop.
+ * @param popped   Pointer where the number of elements popped is stored.
+ * @param priority Pointer where the level they came from is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if every
+ * level is empty).
+ */
+ring_buffer_status_t ring_buffer_priority_pop_n(ring_buffer_priority_t *handle,
+                                                void *elements,
+                                                ring_buffer_index_t count,
+                                                ring_buffer_index_t *popped,
+                                                uint32_t *priority);
+
+/**
+ * @brief Pop up to count elements from one priority level.
+ *
+ * @param handle   Pointer to the priority queue handle.
+ * @param priority Level to pop from (0 is the highest).
+ * @param elements Pointer where up to count elements will be stored.
+ * @param count    Maximum number of elements to pop.
+ * @param popped   Pointer where the number of elements popped is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if that
+ * level is empty).
+ */
+ring_buffer_status_t
+ring_buffer_priority_pop_level_n(ring_buffer_priority_t *handle,
+                                 uint32_t priority, void *elements,
+                                 ring_buffer_index_t count,
+                                 ring_buffer_index_t *popped);
+
+/**
+ * @brief Get the state of the priority queue in constant time.
+ *
+ * @param handle Pointer to the priority queue handle.
+ * @return ring_buffer_status_t RING_BUFFER_EMPTY if every level is empty,
+ * RING_BUFFER_OK otherwise.
+ */
+ring_buffer_status_t
+ring_buffer_priority_state(const ring_buffer_priority_t *handle);
+
+/**
+ * @brief Get the number of elements in all levels.
+ *
+ * @param handle Pointer to the priority queue handle.
+ * @param size   Pointer where the number of elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_priority_size(const ring_buffer_priority_t *handle,
+                          uint64_t *size);
+
+#endif /* RING_BUFFER_PRIORITY_H_ */
@@ -0,0 +1,267 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_sharded.c                                                *
+ * Description:                                                               *
+ *     Implementation of the sharded work-stealing queue functions.           *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "ring_buffer_sharded.h"
+#include <string.h>
+#include <stdint.h>
+
+/* Pop up to count elements from one shard unless another consumer has it */
+static ring_buffer_status_t
+ring_buffer_sharded_take(ring_buffer_sharded_shard_t *shard, void *elements,
+                         ring_buffer_index_t count, ring_buffer_index_t *popped)
+{
+    /* Look before touching the lock so idle shards stay in shared state */
+    if (ring_buffer_spsc_state(&shard->ring) == RING_BUFFER_EMPTY)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+
+    if (atomic_flag_test_and_set_explicit(&shard->consumer_lock,
+                                          memory_order_acquire))
+    {
+        /* Being drained by another consumer: try the next shard */
+        return RING_BUFFER_EMPTY;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_spsc_pop_n(&shard->ring, elements, count, popped);
+
+    atomic_flag_clear_explicit(&shard->consumer_lock, memory_order_release);
+
+    return status;
+}
+
+/* Initialize the sharded queue */
+ring_buffer_status_t
+ring_buffer_sharded_init(ring_buffer_sharded_t *handle, size_t element_size,
+                         ring_buffer_index_t length,
+                         ring_buffer_sharded_shard_t *shards,
+                         uint32_t shard_count, uint8_t *buffer)
+{
+    if ((handle == NULL) || (shards == NULL) || (buffer == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((element_size == 0U) || (length == 0U) || (shard_count == 0U) ||
+        (element_size > (SIZE_MAX / length / shard_count)) ||
+        (((uintptr_t)shards % _Alignof(ring_buffer_sharded_shard_t)) != 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_sharded_t));
+
+    for (uint32_t i = 0U; i < shard_count; i++)
+    {
+        ring_buffer_status_t status;
+
+        (void)memset(&shards[i], 0, sizeof(ring_buffer_sharded_shard_t));
+        status = ring_buffer_spsc_init(
+            &shards[i].ring, element_size, length,
+            &buffer[(size_t)i * element_size * (size_t)length]);
+
+        if (status != RING_BUFFER_OK)
+        {
+            return status;
+        }
+
+        atomic_flag_clear_explicit(&shards[i].consumer_lock,
+                                   memory_order_relaxed);
+    }
+
+    handle->shards = shards;
+    handle->shard_count = shard_count;
+    handle->length = length;
+    handle->element_size = element_size;
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+}
+
+/* Destroy the sharded queue */
+ring_buffer_status_t ring_buffer_sharded_destroy(ring_buffer_sharded_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    for (uint32_t i = 0U; i < handle->shard_count; i++)
+    {
+        (void)ring_buffer_spsc_destroy(&handle->shards[i].ring);
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_sharded_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element into a producer's shard */
+ring_buffer_status_t ring_buffer_sharded_push(ring_buffer_sharded_t *handle,
+                                              uint32_t producer,
+                                              const void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (producer >= handle->shard_count)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    return ring_buffer_spsc_push(&handle->shards[producer].ring, element);
+}
+
+/* Push up to count elements into a producer's shard */
+ring_buffer_status_t ring_buffer_sharded_push_n(ring_buffer_sharded_t *handle,
+                                                uint32_t producer,
+                                                const void *elements,
+                                                ring_buffer_index_t count,
+                                                ring_buffer_index_t *pushed)
+{
+    if ((handle == NULL) || (elements == NULL) || (pushed == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (producer >= handle->shard_count)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    return ring_buffer_spsc_push_n(&handle->shards[producer].ring, elements,
+                                   count, pushed);
+}
+
+/* Pop an element, preferring the consumer's home shard */
+ring_buffer_status_t ring_buffer_sharded_pop(ring_buffer_sharded_t *handle,
+                                             uint32_t home, void *element)
+{
+    ring_buffer_index_t popped;
+
+    return ring_buffer_sharded_pop_n(handle, home, element, 1U, &popped);
+}
+
+/* Pop up to count elements from the home shard or the first non-empty one */
+ring_buffer_status_t ring_buffer_sharded_pop_n(ring_buffer_sharded_t *handle,
+                                               uint32_t home, void *elements,
+                                               ring_buffer_index_t count,
+                                               ring_buffer_index_t *popped)
+{
+    if ((handle == NULL) || (elements == NULL) || (popped == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *popped = 0U;
+
+    if (count == 0U)
+    {
+        return RING_BUFFER_OK;
+    }
+
+    uint32_t index = home % handle->shard_count;
+
+    /* Home shard first, then the others in a fixed order after it */
+    for (uint32_t i = 0U; i < handle->shard_count; i++)
+    {
+        if (ring_buffer_sharded_take(&handle->shards[index], elements, count,
+                                     popped) == RING_BUFFER_OK)
+        {
+            return RING_BUFFER_OK;
+        }
+
+        index = (index + 1U == handle->shard_count) ? 0U : index + 1U;
+    }
+
+    return RING_BUFFER_EMPTY;
+}
+
+/* Get the number of elements in all shards */
+ring_buffer_status_t
+ring_buffer_sharded_size(const ring_buffer_sharded_t *handle, uint64_t *size)
+{
+    if ((handle == NULL) || (size == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    uint64_t total = 0U;
+
+    for (uint32_t i = 0U; i < handle->shard_count; i++)
+    {
+        ring_buffer_index_t count = 0U;
+
+        (void)ring_buffer_spsc_size(&handle->shards[i].ring, &count);
+        total += count;
+    }
+
+    *size = total;
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the total number of elements all shards can hold */
+ring_buffer_status_t
+ring_buffer_sharded_capacity(const ring_buffer_sharded_t *handle,
+                             uint64_t *capacity)
+{
+    if ((handle == NULL) || (capacity == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *capacity = (uint64_t)handle->length * handle->shard_count;
+
+    return RING_BUFFER_OK;
+}
@@ -0,0 +1,180 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_sharded.h                                                *
+ * Description:                                                               *
+ *     Header file defining a multi-producer/multi-consumer queue built from  *
+ *     one SPSC ring per producer, with work-stealing consumers.              *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_SHARDED_H_
+#define RING_BUFFER_SHARDED_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+
+/* Size in bytes of the buffer memory needed by ring_buffer_sharded_init() */
+#define RING_BUFFER_SHARDED_BUFFER_SIZE(element_size, length, shard_count)     \
+    ((size_t)(element_size) * (size_t)(length) * (size_t)(shard_count))
+
+/*
+ * One shard: an SPSC ring owned by a single producer.
+ *
+ * Several consumers may pop from a shard, so they take turns through
+ * consumer_lock. It is only ever tried, never waited on, and lives on its
+ * own cache line next to the ring's consumer block.
+ */
+typedef struct
+{
+    ring_buffer_spsc_t ring;   /* Elements pushed by the shard's producer */
+
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    atomic_flag consumer_lock; /* Held by the consumer popping the shard */
+} ring_buffer_sharded_shard_t;
+
+/*
+ * Structure representing the sharded queue.
+ *
+ * Producer i only pushes to shard i, so pushes never contend and
+ * throughput grows with the number of producers. Consumers drain their
+ * home shard first and steal from the other shards when it is empty.
+ * Elements from one producer keep their order; there is no order between
+ * producers.
+ */
+typedef struct
+{
+    ring_buffer_sharded_shard_t *shards; /* One shard per producer */
+    uint32_t shard_count;       /* Number of shards */
+    ring_buffer_index_t length; /* Number of elements in each shard */
+    size_t element_size;        /* Size of each element in bytes */
+    uint8_t init_flag;          /* Initialization flag */
+} ring_buffer_sharded_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Initialize the sharded queue.
+ *
+ * @param handle       Pointer to the queue handle.
+ * @param element_size Size of each element in bytes.
+ * @param length       Number of elements in each shard.
+ * @param shards       Pointer to shard_count shard structures.
+ * @param shard_count  Number of shards (one per producer thread).
+ * @param buffer       Pointer to RING_BUFFER_SHARDED_BUFFER_SIZE(
+ *                     element_size, length, shard_count) bytes.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_sharded_init(ring_buffer_sharded_t *handle, size_t element_size,
+                         ring_buffer_index_t length,
+                         ring_buffer_sharded_shard_t *shards,
+                         uint32_t shard_count, uint8_t *buffer);
+
+/**
+ * @brief Destroy the sharded queue.
+ *
+ * @param handle Pointer to the queue handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_sharded_destroy(ring_buffer_sharded_t *handle);
+
+/**
+ * @brief Push an element into a producer's shard.
+ *
+ * Each producer index may only be used by one thread at a time.
+ *
+ * @param handle   Pointer to the queue handle.
+ * @param producer Index of the producer's shard.
+ * @param element  Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if that shard
+ * is full).
+ */
+ring_buffer_status_t ring_buffer_sharded_push(ring_buffer_sharded_t *handle,
+                                              uint32_t producer,
+                                              const void *element);
+
+/**
+ * @brief Push up to count elements into a producer's shard.
+ *
+ * @param handle   Pointer to the queue handle.
+ * @param producer Index of the producer's shard.
+ * @param elements Pointer to count contiguous elements.
+ * @param count    Number of elements to push.
+ * @param pushed   Pointer where the number of elements pushed is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if no element
+ * could be pushed).
+ */
+ring_buffer_status_t ring_buffer_sharded_push_n(ring_buffer_sharded_t *handle,
+                                                uint32_t producer,
+                                                const void *elements,
+                                                ring_buffer_index_t count,
+                                                ring_buffer_index_t *pushed);
+
+/**
+ * @brief Pop an element, preferring the consumer's home shard.
+ *
+ * Safe to call from any number of consumer threads.
+ *
+ * @param handle  Pointer to the queue handle.
+ * @param home    Index of the consumer's home shard (taken modulo the
+ *                number of shards).
+ * @param element Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if no shard
+ * had an element that could be taken).
+ */
+ring_buffer_status_t ring_buffer_sharded_pop(ring_buffer_sharded_t *handle,
+                                             uint32_t home, void *element);
+
+/**
+ * @brief Pop up to count elements from a single shard.
+ *
+ * The home shard is tried first; when it is empty the batch is stolen
+ * from the next shard that has elements.
+ *
+ * @param handle   Pointer to the queue handle.
+ * @param home     Index of the consumer's home shard (taken modulo the
+ *                 number of shards).
+ * @param elements Pointer where up to count elements will be stored.
+ * @param count    Maximum number of elements to pop.
+ * @param popped   Pointer where the number of elements popped is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if no element
+ * could be popped).
+ */
+ring_buffer_status_t ring_buffer_sharded_pop_n(ring_buffer_sharded_t *handle,
+                                               uint32_t home, void *elements,
+                                               ring_buffer_index_t count,
+                                               ring_buffer_index_t *popped);
+
+/**
+ * @brief Get the number of elements in all shards.
+ *
+ * The shards are read one after the other, so the total is only a
+ * snapshot while producers and consumers are running.
+ *
+ * @param handle Pointer to the queue handle.
+ * @param size   Pointer where the number of elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_sharded_size(const ring_buffer_sharded_t *handle, uint64_t *size);
+
+/**
+ * @brief Get the total number of elements all shards can hold.
+ *
+ * @param handle   Pointer to the queue handle.
+ * @param capacity Pointer where the capacity is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_sharded_capacity(const ring_buffer_sharded_t *handle,
+                             uint64_t *capacity);
+
+#endif /* RING_BUFFER_SHARDED_H_ */
@@ -0,0 +1,508 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_shm.c                                                    *
+ * Description:                                                               *
+ *     Implementation of the shared-memory inter-process ring buffer          *
+ *     functions.                                                             *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ring_buffer_shm.h"
+#include <string.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* The indices are shared between processes, so they must be address-free */
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2,
+               "shared-memory rings need lock-free 32-bit atomics");
+
+/* Offset of slot 0 from the start of the segment */
+#define RING_BUFFER_SHM_DATA_OFFSET                                            \
+    (((sizeof(ring_buffer_shm_header_t) + RING_BUFFER_CACHE_LINE_SIZE) -       \
+      1U) &                                                                    \
+     ~((size_t)RING_BUFFER_CACHE_LINE_SIZE - 1U))
+
+/* Inline function to get the size of a slot for an element size */
+static inline uint64_t ring_buffer_shm_slot_size(uint32_t kind,
+                                                 uint64_t element_size)
+{
+    return (kind == RING_BUFFER_SHM_MPMC)
+               ? (uint64_t)RING_BUFFER_SHM_MPMC_SLOT_SIZE(element_size)
+               : element_size;
+}
+
+/* Inline function to get the start of the slot for a position */
+static inline uint8_t *ring_buffer_shm_slot(const ring_buffer_shm_t *handle,
+                                            uint32_t pos)
+{
+    return &handle->data[(size_t)(pos & handle->mask) * handle->slot_size];
+}
+
+/* Inline function to get the sequence counter of an MPMC slot */
+static inline _Atomic ring_buffer_shm_seq_t *
+ring_buffer_shm_seq(const ring_buffer_shm_t *handle, uint32_t pos)
+{
+    return (_Atomic ring_buffer_shm_seq_t *)(void *)ring_buffer_shm_slot(
+        handle, pos);
+}
+
+#ifdef __linux__
+/* Map a segment and point the handle at it */
+static ring_buffer_status_t ring_buffer_shm_map(ring_buffer_shm_t *handle,
+                                                int fd, size_t size)
+{
+    void *base =
+        mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (base == MAP_FAILED)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_shm_t));
+
+    handle->header = base;
+    handle->data = (uint8_t *)base + RING_BUFFER_SHM_DATA_OFFSET;
+    handle->mapped_size = size;
+
+    return RING_BUFFER_OK;
+}
+
+/* Copy the ring geometry from the header into the handle */
+static void ring_buffer_shm_load(ring_buffer_shm_t *handle)
+{
+    const ring_buffer_shm_header_t *header = handle->header;
+
+    handle->kind = header->kind;
+    handle->length = header->length;
+    handle->mask = header->mask;
+    handle->element_size = (size_t)header->element_size;
+    handle->slot_size = (size_t)header->slot_size;
+}
+
+/* Check that a mapped header describes a ring that fits the segment */
+static int ring_buffer_shm_valid(const ring_buffer_shm_header_t *header,
+                                 size_t size)
+{
+    uint32_t length = header->length;
+
+    if (((header->kind != RING_BUFFER_SHM_SPSC) &&
+         (header->kind != RING_BUFFER_SHM_MPMC)) ||
+        (length < 2U) || ((length & (length - 1U)) != 0U) ||
+        (header->mask != (length - 1U)) || (header->element_size == 0U) ||
+        (header->slot_size !=
+         ring_buffer_shm_slot_size(header->kind, header->element_size)) ||
+        (header->data_offset != RING_BUFFER_SHM_DATA_OFFSET) ||
+        (header->segment_size != size))
+    {
+        return 0;
+    }
+
+    return header->slot_size <= ((size - header->data_offset) / length);
+}
+#endif
+
+/* Create a named shared-memory ring and attach to it */
+ring_buffer_status_t ring_buffer_shm_create(ring_buffer_shm_t *handle,
+                                            const char *name,
+                                            ring_buffer_shm_kind_t kind,
+                                            size_t element_size,
+                                            uint32_t length)
+{
+    if ((handle == NULL) || (name == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if (((kind != RING_BUFFER_SHM_SPSC) && (kind != RING_BUFFER_SHM_MPMC)) ||
+        (element_size == 0U) || (element_size > (SIZE_MAX / 4U)) ||
+        (length < 2U) || (length > 0x80000000U) ||
+        ((length & (length - 1U)) != 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    size_t slot_size = (size_t)ring_buffer_shm_slot_size(kind, element_size);
+
+    if (slot_size > ((SIZE_MAX - RING_BUFFER_SHM_DATA_OFFSET) / length))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+#ifdef __linux__
+    size_t size = RING_BUFFER_SHM_DATA_OFFSET + (slot_size * length);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, RING_BUFFER_SHM_MODE);
+
+    if (fd < 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    if ((ftruncate(fd, (off_t)size) != 0) ||
+        (ring_buffer_shm_map(handle, fd, size) != RING_BUFFER_OK))
+    {
+        (void)close(fd);
+        (void)shm_unlink(name);
+        return RING_BUFFER_FAIL;
+    }
+
+    /* The mapping keeps the segment alive */
+    (void)close(fd);
+
+    /* The new segment is zero-filled: only the geometry needs writing */
+    ring_buffer_shm_header_t *header = handle->header;
+
+    header->kind = (uint32_t)kind;
+    header->length = length;
+    header->mask = length - 1U;
+    header->element_size = element_size;
+    header->slot_size = slot_size;
+    header->data_offset = RING_BUFFER_SHM_DATA_OFFSET;
+    header->segment_size = size;
+    ring_buffer_shm_load(handle);
+
+    if (kind == RING_BUFFER_SHM_MPMC)
+    {
+        /* Each slot starts out free for the producer of lap 0 */
+        for (uint32_t i = 0U; i < length; i++)
+        {
+            atomic_store_explicit(ring_buffer_shm_seq(handle, i), i,
+                                  memory_order_relaxed);
+        }
+    }
+
+    /* Publish the header to processes waiting in ring_buffer_shm_attach() */
+    atomic_store_explicit(&header->magic, RING_BUFFER_SHM_MAGIC,
+                          memory_order_release);
+
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+#else
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Attach to an existing shared-memory ring */
+ring_buffer_status_t ring_buffer_shm_attach(ring_buffer_shm_t *handle,
+                                            const char *name)
+{
+    if ((handle == NULL) || (name == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+#ifdef __linux__
+    int fd = shm_open(name, O_RDWR, 0);
+    struct stat st;
+
+    if (fd < 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    if (fstat(fd, &st) != 0)
+    {
+        (void)close(fd);
+        return RING_BUFFER_FAIL;
+    }
+
+    /* The creator has not sized the segment yet */
+    if ((size_t)st.st_size < RING_BUFFER_SHM_DATA_OFFSET)
+    {
+        (void)close(fd);
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_shm_map(handle, fd, (size_t)st.st_size);
+
+    (void)close(fd);
+
+    if (status != RING_BUFFER_OK)
+    {
+        return status;
+    }
+
+    ring_buffer_shm_header_t *header = handle->header;
+
+    if (atomic_load_explicit(&header->magic, memory_order_acquire) !=
+        RING_BUFFER_SHM_MAGIC)
+    {
+        status = RING_BUFFER_NOT_INITIALIZED;
+    }
+    else if (!ring_buffer_shm_valid(header, handle->mapped_size))
+    {
+        status = RING_BUFFER_FAIL;
+    }
+
+    if (status != RING_BUFFER_OK)
+    {
+        (void)munmap(handle->header, handle->mapped_size);
+        (void)memset(handle, 0, sizeof(ring_buffer_shm_t));
+        return status;
+    }
+
+    ring_buffer_shm_load(handle);
+
+    /* Start the private caches from the shared state */
+    handle->cached_head =
+        atomic_load_explicit(&header->head, memory_order_acquire);
+    handle->cached_tail =
+        atomic_load_explicit(&header->tail, memory_order_acquire);
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+#else
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Detach from a shared-memory ring */
+ring_buffer_status_t ring_buffer_shm_detach(ring_buffer_shm_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef __linux__
+    (void)munmap(handle->header, handle->mapped_size);
+#endif
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_shm_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Remove the name of a shared-memory ring */
+ring_buffer_status_t ring_buffer_shm_unlink(const char *name)
+{
+    if (name == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+#ifdef __linux__
+    return (shm_unlink(name) == 0) ? RING_BUFFER_OK : RING_BUFFER_FAIL;
+#else
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Push an element into the shared-memory ring */
+ring_buffer_status_t ring_buffer_shm_push(ring_buffer_shm_t *handle,
+                                          const void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_shm_header_t *header = handle->header;
+    uint32_t pos = atomic_load_explicit(&header->head, memory_order_relaxed);
+
+    if (handle->kind == RING_BUFFER_SHM_SPSC)
+    {
+        /* Same protocol as ring_buffer_spsc_push() */
+        if ((pos - handle->cached_tail) == handle->length)
+        {
+            handle->cached_tail =
+                atomic_load_explicit(&header->tail, memory_order_acquire);
+
+            if ((pos - handle->cached_tail) == handle->length)
+            {
+                return RING_BUFFER_FULL;
+            }
+        }
+
+        (void)memcpy(ring_buffer_shm_slot(handle, pos), element,
+                     handle->element_size);
+
+        atomic_store_explicit(&header->head, pos + 1U, memory_order_release);
+
+        return RING_BUFFER_OK;
+    }
+
+    /* Same protocol as ring_buffer_mpmc_push() */
+    _Atomic ring_buffer_shm_seq_t *seq;
+
+    for (;;)
+    {
+        seq = ring_buffer_shm_seq(handle, pos);
+
+        int32_t diff = (int32_t)(
+            atomic_load_explicit(seq, memory_order_acquire) - pos);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&header->head, &pos,
+                                                      pos + 1U,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return RING_BUFFER_FULL;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&header->head, memory_order_relaxed);
+        }
+    }
+
+    (void)memcpy(ring_buffer_shm_slot(handle, pos) +
+                     sizeof(ring_buffer_shm_seq_t),
+                 element, handle->element_size);
+
+    atomic_store_explicit(seq, pos + 1U, memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Pop an element from the shared-memory ring */
+ring_buffer_status_t ring_buffer_shm_pop(ring_buffer_shm_t *handle,
+                                         void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_shm_header_t *header = handle->header;
+    uint32_t pos = atomic_load_explicit(&header->tail, memory_order_relaxed);
+
+    if (handle->kind == RING_BUFFER_SHM_SPSC)
+    {
+        /* Same protocol as ring_buffer_spsc_pop() */
+        if (handle->cached_head == pos)
+        {
+            handle->cached_head =
+                atomic_load_explicit(&header->head, memory_order_acquire);
+
+            if (handle->cached_head == pos)
+            {
+                return RING_BUFFER_EMPTY;
+            }
+        }
+
+        (void)memcpy(element, ring_buffer_shm_slot(handle, pos),
+                     handle->element_size);
+
+        atomic_store_explicit(&header->tail, pos + 1U, memory_order_release);
+
+        return RING_BUFFER_OK;
+    }
+
+    /* Same protocol as ring_buffer_mpmc_pop() */
+    _Atomic ring_buffer_shm_seq_t *seq;
+
+    for (;;)
+    {
+        seq = ring_buffer_shm_seq(handle, pos);
+
+        int32_t diff = (int32_t)(
+            atomic_load_explicit(seq, memory_order_acquire) - (pos + 1U));
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&header->tail, &pos,
+                                                      pos + 1U,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return RING_BUFFER_EMPTY;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&header->tail, memory_order_relaxed);
+        }
+    }
+
+    (void)memcpy(element,
+                 ring_buffer_shm_slot(handle, pos) +
+                     sizeof(ring_buffer_shm_seq_t),
+                 handle->element_size);
+
+    atomic_store_explicit(seq, pos + handle->length, memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the current state of the shared-memory ring */
+ring_buffer_status_t ring_buffer_shm_state(const ring_buffer_shm_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    const ring_buffer_shm_header_t *header = handle->header;
+    uint32_t tail = atomic_load_explicit(&header->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&header->head, memory_order_acquire);
+    uint32_t count = head - tail;
+
+    /* tail is read first, so a stale tail can only overstate the count */
+    if (count == 0U)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+    else if (count >= handle->length)
+    {
+        return RING_BUFFER_FULL;
+    }
+
+    return RING_BUFFER_OK;
+}
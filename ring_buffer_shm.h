@@ -0,0 +1,196 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_shm.h                                                    *
+ * Description:                                                               *
+ *     Header file defining a lock-free ring buffer that lives in a named     *
+ *     POSIX shared-memory segment and can be used across processes.          *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_SHM_H_
+#define RING_BUFFER_SHM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+
+/* Value stored in the segment header once it is fully set up ("RBS" v2) */
+#define RING_BUFFER_SHM_MAGIC 0x52425302U
+
+/* Permissions of newly created segments */
+#ifndef RING_BUFFER_SHM_MODE
+#define RING_BUFFER_SHM_MODE 0600
+#endif
+
+/* Sequence counter of an MPMC slot, as wide as head and tail */
+typedef uint32_t ring_buffer_shm_seq_t;
+
+/* Size in bytes of one MPMC slot (sequence counter followed by the element) */
+#define RING_BUFFER_SHM_MPMC_SLOT_SIZE(element_size)                           \
+    ((((sizeof(ring_buffer_shm_seq_t) + (size_t)(element_size)) +              \
+       sizeof(ring_buffer_shm_seq_t) - 1U) /                                   \
+      sizeof(ring_buffer_shm_seq_t)) *                                         \
+     sizeof(ring_buffer_shm_seq_t))
+
+/* Enumeration for the index scheme used by a shared-memory ring */
+typedef enum
+{
+    RING_BUFFER_SHM_SPSC, /* One producer and one consumer process */
+    RING_BUFFER_SHM_MPMC  /* Any number of producers and consumers */
+} ring_buffer_shm_kind_t;
+
+/*
+ * Header at the start of the shared-memory segment.
+ *
+ * It only holds fixed-width fields and offsets, never pointers, so every
+ * process can map the segment at a different address. The slots start
+ * data_offset bytes after the header; MPMC slots carry a sequence counter
+ * as in ring_buffer_mpmc_t. head and tail are free-running counters on
+ * their own cache lines and the index state survives any process
+ * restarting.
+ *
+ * Positions and slot sequences are always 32 bits, whatever
+ * RING_BUFFER_INDEX_BITS and RING_BUFFER_MPMC_SEQ_BITS are, so processes
+ * built with different settings agree on the layout; wider atomics are not
+ * lock-free, and so not address-free, everywhere. Unlike a 64-bit
+ * ring_buffer_mpmc_t, an MPMC thread stalled between reading a position and
+ * its CAS for 2^32 operations could therefore see it come round again.
+ */
+typedef struct
+{
+    _Atomic uint32_t magic; /* RING_BUFFER_SHM_MAGIC once set up */
+    uint32_t kind;          /* ring_buffer_shm_kind_t */
+    uint32_t length;        /* Number of slots (power of two) */
+    uint32_t mask;          /* length - 1 */
+    uint64_t element_size;  /* Size of each element in bytes */
+    uint64_t slot_size;     /* Size of each slot in bytes */
+    uint64_t data_offset;   /* Offset of slot 0 from the header */
+    uint64_t segment_size;  /* Size of the whole segment in bytes */
+
+    /* Producer-side block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t head;  /* Next position to write */
+
+    /* Consumer-side block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic uint32_t tail;  /* Next position to read */
+} ring_buffer_shm_header_t;
+
+/*
+ * Structure representing one process's view of a shared-memory ring.
+ *
+ * The geometry is copied out of the header when attaching so that a
+ * misbehaving peer cannot change it under a running process.
+ */
+typedef struct
+{
+    ring_buffer_shm_header_t *header; /* Start of the mapping */
+    uint8_t *data;                    /* Slot 0 in this process */
+    size_t mapped_size;               /* Size of the mapping in bytes */
+    uint32_t kind;                    /* ring_buffer_shm_kind_t */
+    uint32_t length;                  /* Number of slots (power of two) */
+    uint32_t mask;                    /* length - 1 */
+    size_t element_size;              /* Size of each element in bytes */
+    size_t slot_size;                 /* Size of each slot in bytes */
+    uint32_t cached_head;             /* SPSC consumer's last seen head */
+    uint32_t cached_tail;             /* SPSC producer's last seen tail */
+    uint8_t init_flag;                /* Initialization flag */
+} ring_buffer_shm_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Create a named shared-memory ring and attach to it.
+ *
+ * Fails if a segment with that name already exists; a restarted process
+ * should use ring_buffer_shm_attach() instead. Other processes see the
+ * segment as not initialized until the header is complete. Only available
+ * on Linux.
+ *
+ * @param handle       Pointer to the ring buffer handle.
+ * @param name         Segment name ("/name", see shm_open()).
+ * @param kind         Index scheme (RING_BUFFER_SHM_SPSC or _MPMC).
+ * @param element_size Size of each element in bytes.
+ * @param length       Number of elements in the buffer (power of two).
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the segment
+ * could not be created).
+ */
+ring_buffer_status_t ring_buffer_shm_create(ring_buffer_shm_t *handle,
+                                            const char *name,
+                                            ring_buffer_shm_kind_t kind,
+                                            size_t element_size,
+                                            uint32_t length);
+
+/**
+ * @brief Attach to an existing shared-memory ring.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param name   Segment name given to ring_buffer_shm_create().
+ * @return ring_buffer_status_t Status code (RING_BUFFER_NOT_INITIALIZED if
+ * the creator has not finished setting it up, RING_BUFFER_FAIL if it does
+ * not exist or is not a valid ring).
+ */
+ring_buffer_status_t ring_buffer_shm_attach(ring_buffer_shm_t *handle,
+                                            const char *name);
+
+/**
+ * @brief Detach from a shared-memory ring.
+ *
+ * The segment and its contents stay in place for other processes.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_shm_detach(ring_buffer_shm_t *handle);
+
+/**
+ * @brief Remove the name of a shared-memory ring.
+ *
+ * Processes still attached keep working; the memory is released when the
+ * last one detaches.
+ *
+ * @param name Segment name given to ring_buffer_shm_create().
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_shm_unlink(const char *name);
+
+/**
+ * @brief Push an element into the shared-memory ring.
+ *
+ * SPSC rings allow a single producer process (and thread) at a time.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_shm_push(ring_buffer_shm_t *handle,
+                                          const void *element);
+
+/**
+ * @brief Pop an element from the shared-memory ring.
+ *
+ * SPSC rings allow a single consumer process (and thread) at a time.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param element Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_shm_pop(ring_buffer_shm_t *handle,
+                                         void *element);
+
+/**
+ * @brief Get the current state of the shared-memory ring.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY,
+ * RING_BUFFER_FULL, or RING_BUFFER_OK).
+ */
+ring_buffer_status_t ring_buffer_shm_state(const ring_buffer_shm_t *handle);
+
+#endif /* RING_BUFFER_SHM_H_ */
@@ -0,0 +1,957 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_spsc.c                                                   *
+ * Description:                                                               *
+ *     Implementation of the lock-free single-producer/single-consumer        *
+ *     ring buffer functions.                                                 *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_alloc.h"
+#include "ring_buffer_copy.h"
+#include "ring_buffer_internal.h"
+#include "ring_buffer_inline.h"
+#include <string.h>
+#include <stdint.h>
+
+/* Inline function to get the number of slots addressable without wrapping */
+static inline ring_buffer_index_t
+ring_buffer_spsc_span(const ring_buffer_spsc_t *handle)
+{
+    return (handle->is_mirrored != 0U) ? (2U * handle->length)
+                                       : handle->length;
+}
+
+/* Initialize the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_init(ring_buffer_spsc_t *handle,
+                                           size_t element_size,
+                                           ring_buffer_index_t length,
+                                           uint8_t *buffer)
+{
+    if ((handle == NULL) || (buffer == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((element_size == 0U) || (length < 2U) ||
+        (length > RING_BUFFER_INDEX_LENGTH_MAX))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_spsc_t));
+
+    handle->element_size = element_size;
+    handle->length = length;
+    handle->buffer = buffer;
+    handle->mask = ((length & (length - 1U)) == 0U) ? (length - 1U) : 0U;
+    (void)ring_buffer_copy_select(element_size, length, &handle->stream_in);
+
+    atomic_init(&handle->head, 0U);
+    atomic_init(&handle->tail, 0U);
+    handle->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+}
+
+/* Initialize the SPSC ring buffer over a mirrored buffer */
+ring_buffer_status_t ring_buffer_spsc_init_mirrored(ring_buffer_spsc_t *handle,
+                                                    size_t element_size,
+                                                    ring_buffer_index_t length,
+                                                    uint8_t *buffer)
+{
+    if (length >= RING_BUFFER_INDEX_LENGTH_MAX)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_status_t status =
+        ring_buffer_spsc_init(handle, element_size, length, buffer);
+
+    if (status == RING_BUFFER_OK)
+    {
+        handle->is_mirrored = 1U;
+    }
+
+    return status;
+}
+
+/* Allocate a buffer and initialize the SPSC ring buffer over it */
+ring_buffer_status_t
+ring_buffer_spsc_create(ring_buffer_spsc_t *handle, size_t element_size,
+                        ring_buffer_index_t length,
+                        const ring_buffer_alloc_options_t *options)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if ((element_size == 0U) || (length < 2U) ||
+        (element_size > (SIZE_MAX / length)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    ring_buffer_block_t block;
+    ring_buffer_status_t status =
+        ring_buffer_block_alloc(&block, element_size * length, options);
+
+    if (status != RING_BUFFER_OK)
+    {
+        return status;
+    }
+
+    status = (block.kind == RING_BUFFER_BLOCK_MIRROR)
+                 ? ring_buffer_spsc_init_mirrored(handle, element_size,
+                                                  length, block.buffer)
+                 : ring_buffer_spsc_init(handle, element_size, length,
+                                         block.buffer);
+
+    if (status != RING_BUFFER_OK)
+    {
+        (void)ring_buffer_block_free(&block);
+        return status;
+    }
+
+    handle->is_dynamic = 1U;
+    handle->alloc_kind = block.kind;
+    handle->alloc_size = block.size;
+
+    return RING_BUFFER_OK;
+}
+
+/* Destroy the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_destroy(ring_buffer_spsc_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    /* Free the buffer if ring_buffer_spsc_create() allocated it */
+    if (handle->is_dynamic != 0U)
+    {
+        ring_buffer_block_t block = {handle->buffer, handle->alloc_size,
+                                     handle->alloc_kind};
+
+        (void)ring_buffer_block_free(&block);
+    }
+
+    /* Clear the handle structure */
+    (void)memset(handle, 0, sizeof(ring_buffer_spsc_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element into the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_push(ring_buffer_spsc_t *handle,
+                                           const void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    return ring_buffer_spsc_push_unchecked(handle, element);
+}
+
+/* Pop an element from the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_pop(ring_buffer_spsc_t *handle,
+                                          void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    return ring_buffer_spsc_pop_unchecked(handle, element);
+}
+
+/* Set how many deferred pushes and pops are published at once */
+ring_buffer_status_t
+ring_buffer_spsc_set_publish_batch(ring_buffer_spsc_t *handle,
+                                   ring_buffer_index_t push_batch,
+                                   ring_buffer_index_t pop_batch)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    handle->push_batch = push_batch;
+    handle->pop_batch = pop_batch;
+
+    return RING_BUFFER_OK;
+}
+
+/* Set how many slots ahead of head the producer prefetches for writing */
+ring_buffer_status_t
+ring_buffer_spsc_set_prefetch_distance(ring_buffer_spsc_t *handle,
+                                       ring_buffer_index_t distance)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if (distance >= handle->length)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    handle->prefetch_distance = distance;
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element without publishing it to the consumer yet */
+ring_buffer_status_t ring_buffer_spsc_push_deferred(ring_buffer_spsc_t *handle,
+                                                    const void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t head = handle->local_head;
+
+    if (ring_buffer_spsc_count(handle, head, handle->cached_tail) ==
+        handle->length)
+    {
+        handle->cached_tail =
+            atomic_load_explicit(&handle->tail, memory_order_acquire);
+
+        if (ring_buffer_spsc_count(handle, head, handle->cached_tail) ==
+            handle->length)
+        {
+            /* The consumer can only make room once it sees the backlog */
+            atomic_store_explicit(&handle->head, head, memory_order_release);
+            RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+            return RING_BUFFER_FULL;
+        }
+    }
+
+    size_t offset =
+        (size_t)ring_buffer_spsc_slot(handle, head) * handle->element_size;
+    ring_buffer_store(handle->stream_in, &handle->buffer[offset], element,
+                      handle->element_size);
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                              ring_buffer_spsc_slot(handle, head), 1U);
+    ring_buffer_spsc_prefetch(handle, head, 1U);
+
+    head = ring_buffer_spsc_next_index(handle, head, 1U);
+    handle->local_head = head;
+
+    /* Only the producer stores head, so a relaxed load sees the last store */
+    if ((handle->push_batch != 0U) &&
+        (ring_buffer_spsc_count(handle, head,
+                                atomic_load_explicit(&handle->head,
+                                                     memory_order_relaxed)) >=
+         handle->push_batch))
+    {
+        atomic_store_explicit(&handle->head, head, memory_order_release);
+    }
+
+    ring_buffer_spsc_stats_push(handle, head, 1U);
+
+    return RING_BUFFER_OK;
+}
+
+/* Publish every deferred push to the consumer */
+ring_buffer_status_t ring_buffer_spsc_publish_head(ring_buffer_spsc_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    atomic_store_explicit(&handle->head, handle->local_head,
+                          memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Pop an element without handing its slot back to the producer yet */
+ring_buffer_status_t ring_buffer_spsc_pop_deferred(ring_buffer_spsc_t *handle,
+                                                   void *element)
+{
+    if ((handle == NULL) || (element == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t tail = handle->local_tail;
+
+    if (handle->cached_head == tail)
+    {
+        handle->cached_head =
+            atomic_load_explicit(&handle->head, memory_order_acquire);
+
+        if (handle->cached_head == tail)
+        {
+            /* Give the producer its room back before reporting empty */
+            atomic_store_explicit(&handle->tail, tail, memory_order_release);
+            RING_BUFFER_STAT_ADD(handle->consumer_stats.empty_rejects, 1U);
+            return RING_BUFFER_EMPTY;
+        }
+    }
+
+    size_t offset =
+        (size_t)ring_buffer_spsc_slot(handle, tail) * handle->element_size;
+    (void)memcpy(element, &handle->buffer[offset], handle->element_size);
+    RING_BUFFER_LATENCY_RECORD(handle->latency, handle->stamps, handle->length,
+                               ring_buffer_spsc_slot(handle, tail), 1U);
+
+    tail = ring_buffer_spsc_next_index(handle, tail, 1U);
+    handle->local_tail = tail;
+
+    /* Only the consumer stores tail, so a relaxed load sees the last store */
+    if ((handle->pop_batch != 0U) &&
+        (ring_buffer_spsc_count(handle, tail,
+                                atomic_load_explicit(&handle->tail,
+                                                     memory_order_relaxed)) >=
+         handle->pop_batch))
+    {
+        atomic_store_explicit(&handle->tail, tail, memory_order_release);
+    }
+
+    RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, 1U);
+
+    return RING_BUFFER_OK;
+}
+
+/* Hand every slot freed by deferred pops back to the producer */
+ring_buffer_status_t ring_buffer_spsc_publish_tail(ring_buffer_spsc_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    atomic_store_explicit(&handle->tail, handle->local_tail,
+                          memory_order_release);
+
+    return RING_BUFFER_OK;
+}
+
+/* Push up to count elements into the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_push_n(ring_buffer_spsc_t *handle,
+                                             const void *elements,
+                                             ring_buffer_index_t count,
+                                             ring_buffer_index_t *pushed)
+{
+    if ((handle == NULL) || (elements == NULL) || (pushed == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t head = handle->local_head;
+    ring_buffer_index_t space = handle->length -
+                     ring_buffer_spsc_count(handle, head, handle->cached_tail);
+
+    if (space < count)
+    {
+        handle->cached_tail =
+            atomic_load_explicit(&handle->tail, memory_order_acquire);
+        space = handle->length -
+                ring_buffer_spsc_count(handle, head, handle->cached_tail);
+    }
+
+    ring_buffer_index_t n = (count < space) ? count : space;
+
+    *pushed = n;
+
+    if (n == 0U)
+    {
+        if (count == 0U)
+        {
+            return RING_BUFFER_OK;
+        }
+
+        RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+        return RING_BUFFER_FULL;
+    }
+
+    ring_buffer_copy_in(handle->stream_in, handle->buffer,
+                        ring_buffer_spsc_span(handle),
+                        handle->element_size,
+                        ring_buffer_spsc_slot(handle, head),
+                        (const uint8_t *)elements, n);
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                              ring_buffer_spsc_slot(handle, head), n);
+    ring_buffer_spsc_prefetch(handle, head, n);
+
+    /* Publish the whole batch to the consumer at once */
+    head = ring_buffer_spsc_next_index(handle, head, n);
+    handle->local_head = head;
+    atomic_store_explicit(&handle->head, head, memory_order_release);
+    ring_buffer_spsc_stats_push(handle, head, n);
+
+    return RING_BUFFER_OK;
+}
+
+/* Push up to count elements, publishing only whole cache lines */
+ring_buffer_status_t ring_buffer_spsc_push_lines(ring_buffer_spsc_t *handle,
+                                                 const void *elements,
+                                                 ring_buffer_index_t count,
+                                                 ring_buffer_index_t *pushed)
+{
+    if ((handle == NULL) || (elements == NULL) || (pushed == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t head = handle->local_head;
+    ring_buffer_index_t space = handle->length -
+                     ring_buffer_spsc_count(handle, head, handle->cached_tail);
+
+    if (space < count)
+    {
+        handle->cached_tail =
+            atomic_load_explicit(&handle->tail, memory_order_acquire);
+        space = handle->length -
+                ring_buffer_spsc_count(handle, head, handle->cached_tail);
+    }
+
+    ring_buffer_index_t n = (count < space) ? count : space;
+
+    *pushed = n;
+
+    if (n == 0U)
+    {
+        if (count != 0U)
+        {
+            /* The consumer can only make room once it sees the backlog */
+            atomic_store_explicit(&handle->head, head, memory_order_release);
+            RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+            return RING_BUFFER_FULL;
+        }
+
+        return RING_BUFFER_OK;
+    }
+
+    ring_buffer_copy_in(handle->stream_in, handle->buffer,
+                        ring_buffer_spsc_span(handle),
+                        handle->element_size,
+                        ring_buffer_spsc_slot(handle, head),
+                        (const uint8_t *)elements, n);
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                              ring_buffer_spsc_slot(handle, head), n);
+    ring_buffer_spsc_prefetch(handle, head, n);
+
+    head = ring_buffer_spsc_next_index(handle, head, n);
+    handle->local_head = head;
+
+    /* Only the producer stores head, so a relaxed load sees the last store */
+    ring_buffer_index_t published =
+        atomic_load_explicit(&handle->head, memory_order_relaxed);
+    ring_buffer_index_t pending =
+        ring_buffer_spsc_count(handle, head, published);
+
+    /*
+     * Hold back the slots sharing a cache line with the next write, so the
+     * consumer does not pull that line away while it is still being filled.
+     * A full ring publishes everything, or the producer would wait forever.
+     */
+    if (n < space)
+    {
+        ring_buffer_index_t slot = ring_buffer_spsc_slot(handle, head);
+        size_t line = ((size_t)slot * handle->element_size) &
+                      ~((size_t)RING_BUFFER_CACHE_LINE_SIZE - 1U);
+        ring_buffer_index_t partial =
+            slot - (ring_buffer_index_t)(line / handle->element_size);
+
+        pending -= (partial < pending) ? partial : pending;
+    }
+
+    if (pending != 0U)
+    {
+        atomic_store_explicit(
+            &handle->head,
+            ring_buffer_spsc_next_index(handle, published, pending),
+            memory_order_release);
+    }
+
+    ring_buffer_spsc_stats_push(handle, head, n);
+
+    return RING_BUFFER_OK;
+}
+
+/* Pop up to count elements from the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_pop_n(ring_buffer_spsc_t *handle,
+                                            void *elements,
+                                            ring_buffer_index_t count,
+                                            ring_buffer_index_t *popped)
+{
+    if ((handle == NULL) || (elements == NULL) || (popped == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t tail = handle->local_tail;
+    ring_buffer_index_t used =
+        ring_buffer_spsc_count(handle, handle->cached_head, tail);
+
+    if (used < count)
+    {
+        handle->cached_head =
+            atomic_load_explicit(&handle->head, memory_order_acquire);
+        used = ring_buffer_spsc_count(handle, handle->cached_head, tail);
+    }
+
+    ring_buffer_index_t n = (count < used) ? count : used;
+
+    *popped = n;
+
+    if (n == 0U)
+    {
+        if (count == 0U)
+        {
+            return RING_BUFFER_OK;
+        }
+
+        /* Give the producer the room of any deferred pops back */
+        atomic_store_explicit(&handle->tail, tail, memory_order_release);
+        RING_BUFFER_STAT_ADD(handle->consumer_stats.empty_rejects, 1U);
+        return RING_BUFFER_EMPTY;
+    }
+
+    ring_buffer_copy_out(handle->buffer, ring_buffer_spsc_span(handle),
+                         handle->element_size,
+                         ring_buffer_spsc_slot(handle, tail),
+                         (uint8_t *)elements, n);
+    RING_BUFFER_LATENCY_RECORD(handle->latency, handle->stamps, handle->length,
+                               ring_buffer_spsc_slot(handle, tail), n);
+
+    /* Hand the whole batch back to the producer at once */
+    handle->local_tail = ring_buffer_spsc_next_index(handle, tail, n);
+    atomic_store_explicit(&handle->tail, handle->local_tail,
+                          memory_order_release);
+    RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, n);
+
+    return RING_BUFFER_OK;
+}
+
+/* Reserve contiguous space for up to count elements at the head */
+ring_buffer_status_t ring_buffer_spsc_reserve(ring_buffer_spsc_t *handle,
+                                              ring_buffer_index_t count,
+                                              void **ptr,
+                                              ring_buffer_index_t *contig)
+{
+    if ((handle == NULL) || (ptr == NULL) || (contig == NULL) ||
+        (count == 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t head = handle->local_head;
+    ring_buffer_index_t slot = ring_buffer_spsc_slot(handle, head);
+    ring_buffer_index_t space = handle->length -
+                     ring_buffer_spsc_count(handle, head, handle->cached_tail);
+    ring_buffer_index_t n = ring_buffer_spsc_span(handle) - slot;
+
+    n = (n < count) ? n : count;
+
+    if (space < n)
+    {
+        handle->cached_tail =
+            atomic_load_explicit(&handle->tail, memory_order_acquire);
+        space = handle->length -
+                ring_buffer_spsc_count(handle, head, handle->cached_tail);
+    }
+
+    n = (n < space) ? n : space;
+
+    *ptr = &handle->buffer[(size_t)slot * handle->element_size];
+    *contig = n;
+
+    if (n == 0U)
+    {
+        RING_BUFFER_STAT_ADD(handle->producer_stats.full_rejects, 1U);
+        return RING_BUFFER_FULL;
+    }
+
+    return RING_BUFFER_OK;
+}
+
+/* Make count reserved elements available to the consumer */
+ring_buffer_status_t ring_buffer_spsc_commit(ring_buffer_spsc_t *handle,
+                                             ring_buffer_index_t count)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t head = handle->local_head;
+
+    /* The reservation already refreshed cached_tail, so it bounds count */
+    if (count > (handle->length -
+                 ring_buffer_spsc_count(handle, head, handle->cached_tail)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    RING_BUFFER_LATENCY_STAMP(handle->stamps, handle->length,
+                              ring_buffer_spsc_slot(handle, head), count);
+    ring_buffer_spsc_prefetch(handle, head, count);
+    head = ring_buffer_spsc_next_index(handle, head, count);
+    handle->local_head = head;
+    atomic_store_explicit(&handle->head, head, memory_order_release);
+    ring_buffer_spsc_stats_push(handle, head, count);
+
+    return RING_BUFFER_OK;
+}
+
+/* Get a pointer to up to count contiguous elements at the tail */
+ring_buffer_status_t ring_buffer_spsc_peek(ring_buffer_spsc_t *handle,
+                                           ring_buffer_index_t count,
+                                           void **ptr,
+                                           ring_buffer_index_t *contig)
+{
+    if ((handle == NULL) || (ptr == NULL) || (contig == NULL) ||
+        (count == 0U))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t tail = handle->local_tail;
+    ring_buffer_index_t slot = ring_buffer_spsc_slot(handle, tail);
+    ring_buffer_index_t used =
+        ring_buffer_spsc_count(handle, handle->cached_head, tail);
+    ring_buffer_index_t n = ring_buffer_spsc_span(handle) - slot;
+
+    n = (n < count) ? n : count;
+
+    if (used < n)
+    {
+        handle->cached_head =
+            atomic_load_explicit(&handle->head, memory_order_acquire);
+        used = ring_buffer_spsc_count(handle, handle->cached_head, tail);
+    }
+
+    n = (n < used) ? n : used;
+
+    *ptr = &handle->buffer[(size_t)slot * handle->element_size];
+    *contig = n;
+
+    if (n == 0U)
+    {
+        /* Give the producer the room of any deferred pops back */
+        atomic_store_explicit(&handle->tail, tail, memory_order_release);
+        RING_BUFFER_STAT_ADD(handle->consumer_stats.empty_rejects, 1U);
+        return RING_BUFFER_EMPTY;
+    }
+
+    return RING_BUFFER_OK;
+}
+
+/* Give count peeked elements back to the producer */
+ring_buffer_status_t ring_buffer_spsc_release(ring_buffer_spsc_t *handle,
+                                              ring_buffer_index_t count)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t tail = handle->local_tail;
+
+    /* The peek already refreshed cached_head, so it bounds count */
+    if (count > ring_buffer_spsc_count(handle, handle->cached_head, tail))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    RING_BUFFER_LATENCY_RECORD(handle->latency, handle->stamps, handle->length,
+                               ring_buffer_spsc_slot(handle, tail), count);
+    handle->local_tail = ring_buffer_spsc_next_index(handle, tail, count);
+    atomic_store_explicit(&handle->tail, handle->local_tail,
+                          memory_order_release);
+    RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, count);
+
+    return RING_BUFFER_OK;
+}
+
+/* Drop every element currently in the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_drain(ring_buffer_spsc_t *handle,
+                                            ring_buffer_index_t *drained)
+{
+    if ((handle == NULL) || (drained == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t tail = handle->local_tail;
+
+    handle->cached_head =
+        atomic_load_explicit(&handle->head, memory_order_acquire);
+    *drained = ring_buffer_spsc_count(handle, handle->cached_head, tail);
+
+    /* Hand every slot up to the observed head back to the producer */
+    handle->local_tail = handle->cached_head;
+    atomic_store_explicit(&handle->tail, handle->local_tail,
+                          memory_order_release);
+    RING_BUFFER_STAT_ADD(handle->consumer_stats.pops, *drained);
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the current state of the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_state(const ring_buffer_spsc_t *handle)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t tail =
+        atomic_load_explicit(&handle->tail, memory_order_acquire);
+    ring_buffer_index_t head =
+        atomic_load_explicit(&handle->head, memory_order_acquire);
+    ring_buffer_index_t count = ring_buffer_spsc_count(handle, head, tail);
+
+    if (count == 0U)
+    {
+        return RING_BUFFER_EMPTY;
+    }
+    else if (count == handle->length)
+    {
+        return RING_BUFFER_FULL;
+    }
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the number of elements in the SPSC ring buffer */
+ring_buffer_status_t ring_buffer_spsc_size(const ring_buffer_spsc_t *handle,
+                                           ring_buffer_index_t *size)
+{
+    if ((handle == NULL) || (size == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_index_t tail =
+        atomic_load_explicit(&handle->tail, memory_order_acquire);
+    ring_buffer_index_t head =
+        atomic_load_explicit(&handle->head, memory_order_acquire);
+
+    ring_buffer_index_t count = ring_buffer_spsc_count(handle, head, tail);
+
+    /* tail is read first, so a stale tail can only overstate the count */
+    *size = (count > handle->length) ? handle->length : count;
+
+    return RING_BUFFER_OK;
+}
+
+/* Get the number of elements the SPSC ring buffer can hold */
+ring_buffer_status_t
+ring_buffer_spsc_capacity(const ring_buffer_spsc_t *handle,
+                          ring_buffer_index_t *capacity)
+{
+    if ((handle == NULL) || (capacity == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    *capacity = handle->length;
+
+    return RING_BUFFER_OK;
+}
+
+/* Take a snapshot of the SPSC ring buffer counters */
+ring_buffer_status_t ring_buffer_spsc_stats(const ring_buffer_spsc_t *handle,
+                                            ring_buffer_stats_t *stats)
+{
+    if ((handle == NULL) || (stats == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_stats_read(&handle->producer_stats, &handle->consumer_stats,
+                           stats);
+
+    return RING_BUFFER_OK;
+#else
+    (void)memset(stats, 0, sizeof(ring_buffer_stats_t));
+
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Start timestamping elements to measure how long they are queued */
+ring_buffer_status_t
+ring_buffer_spsc_set_latency_stamps(ring_buffer_spsc_t *handle,
+                                    uint64_t *stamps)
+{
+    if (handle == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef RING_BUFFER_ENABLE_LATENCY
+    handle->stamps = stamps;
+
+    return RING_BUFFER_OK;
+#else
+    (void)stamps;
+
+    return RING_BUFFER_FAIL;
+#endif
+}
+
+/* Take a snapshot of the dwell-time histogram */
+ring_buffer_status_t
+ring_buffer_spsc_latency(const ring_buffer_spsc_t *handle,
+                         ring_buffer_latency_t *latency)
+{
+    if ((handle == NULL) || (latency == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (handle->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+#ifdef RING_BUFFER_ENABLE_LATENCY
+    ring_buffer_latency_read(&handle->latency, latency);
+
+    return RING_BUFFER_OK;
+#else
+    (void)memset(latency, 0, sizeof(ring_buffer_latency_t));
+
+    return RING_BUFFER_FAIL;
+#endif
+}
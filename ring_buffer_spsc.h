@@ -0,0 +1,460 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_spsc.h                                                   *
+ * Description:                                                               *
+ *     Header file defining a lock-free single-producer/single-consumer       *
+ *     ring buffer built on C11 atomics.                                      *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_SPSC_H_
+#define RING_BUFFER_SPSC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+
+/*
+ * Structure representing the SPSC ring buffer.
+ *
+ * head and tail run over [0, 2 * length) so that a full buffer (head - tail
+ * == length) can be told apart from an empty one (head == tail) without any
+ * shared flag bits. When length is a power of two they are free-running
+ * counters instead and slots are found by masking. Only the producer
+ * stores head and only the consumer stores tail.
+ *
+ * The read-only configuration, the producer state and the consumer state
+ * each start on their own cache line. Each side keeps a private copy of the
+ * other side's index and only reloads the shared one when that copy says
+ * the buffer is full (producer) or empty (consumer). Handles allocated on
+ * the heap must honour the structure alignment (e.g. aligned_alloc).
+ *
+ * local_head and local_tail are each side's real position. The shared head
+ * and tail can lag behind them while deferred pushes or pops are pending;
+ * every other producer (consumer) call publishes the pending ones too.
+ */
+typedef struct
+{
+    uint8_t *buffer;          /* Pointer to the buffer memory */
+    ring_buffer_index_t length; /* Number of elements in the buffer */
+    ring_buffer_index_t mask; /* length - 1 for power-of-two lengths, else 0 */
+    size_t element_size;      /* Size of each element in bytes */
+    uint8_t is_mirrored;      /* Buffer is mapped twice back-to-back */
+    uint8_t is_dynamic;       /* Buffer was allocated by the create call */
+    uint8_t alloc_kind;       /* How a dynamic buffer was obtained */
+    size_t alloc_size;        /* Size of a dynamic buffer in bytes */
+    ring_buffer_copy_fn_t stream_in; /* Streaming push copy, or NULL */
+#ifdef RING_BUFFER_ENABLE_LATENCY
+    uint64_t *stamps;         /* Push time of each slot, or NULL */
+#endif
+    uint8_t init_flag;        /* Initialization flag */
+
+    /* Producer-owned block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic ring_buffer_index_t head; /* Write position seen by the consumer */
+    ring_buffer_index_t local_head;   /* Producer's next write position */
+    ring_buffer_index_t cached_tail;  /* Producer's last observed tail */
+    ring_buffer_index_t push_batch;   /* Deferred pushes published together */
+    ring_buffer_index_t prefetch_distance; /* Slots prefetched ahead of head */
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_producer_stats_t producer_stats; /* Push-side counters */
+#endif
+
+    /* Consumer-owned block */
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE)
+    _Atomic ring_buffer_index_t tail; /* Read position seen by the producer */
+    ring_buffer_index_t local_tail;   /* Consumer's next read position */
+    ring_buffer_index_t cached_head;  /* Consumer's last observed head */
+    ring_buffer_index_t pop_batch;    /* Deferred pops published together */
+#ifdef RING_BUFFER_ENABLE_STATS
+    ring_buffer_consumer_stats_t consumer_stats; /* Pop-side counters */
+#endif
+#ifdef RING_BUFFER_ENABLE_LATENCY
+    ring_buffer_latency_histogram_t latency; /* Dwell-time histogram */
+#endif
+} ring_buffer_spsc_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Initialize the SPSC ring buffer.
+ *
+ * @param handle        Pointer to the ring buffer handle.
+ * @param element_size  Size of each element in bytes.
+ * @param length        Number of elements in the buffer (at most
+ *                      RING_BUFFER_INDEX_LENGTH_MAX).
+ * @param buffer        Pointer to the buffer memory (must not be NULL).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_init(ring_buffer_spsc_t *handle,
+                                           size_t element_size,
+                                           ring_buffer_index_t length,
+                                           uint8_t *buffer);
+
+/**
+ * @brief Initialize the SPSC ring buffer over a mirrored buffer.
+ *
+ * buffer must map length * element_size bytes twice back-to-back (see
+ * ring_buffer_mirror.h). Bulk, reserve and peek operations then always see
+ * the whole free or used span as contiguous.
+ *
+ * @param handle        Pointer to the ring buffer handle.
+ * @param element_size  Size of each element in bytes.
+ * @param length        Number of elements in the buffer (below
+ *                      RING_BUFFER_INDEX_LENGTH_MAX).
+ * @param buffer        Pointer to the first half of the mirrored mapping.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_init_mirrored(ring_buffer_spsc_t *handle,
+                                                    size_t element_size,
+                                                    ring_buffer_index_t length,
+                                                    uint8_t *buffer);
+
+/**
+ * @brief Allocate a buffer and initialize the SPSC ring buffer over it.
+ *
+ * Takes the same options as ring_buffer_create(); with
+ * RING_BUFFER_ALLOC_MIRRORED the ring is set up as by
+ * ring_buffer_spsc_init_mirrored(). ring_buffer_spsc_destroy() frees the
+ * buffer.
+ *
+ * @param handle        Pointer to the ring buffer handle.
+ * @param element_size  Size of each element in bytes.
+ * @param length        Number of elements in the buffer (at most
+ *                      RING_BUFFER_INDEX_LENGTH_MAX).
+ * @param options       Allocation options, or NULL for the defaults.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FAIL if the memory
+ * could not be allocated or bound).
+ */
+ring_buffer_status_t
+ring_buffer_spsc_create(ring_buffer_spsc_t *handle, size_t element_size,
+                        ring_buffer_index_t length,
+                        const ring_buffer_alloc_options_t *options);
+
+/**
+ * @brief Destroy the SPSC ring buffer.
+ *
+ * Frees the buffer if it was allocated by ring_buffer_spsc_create().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_destroy(ring_buffer_spsc_t *handle);
+
+/**
+ * @brief Push an element into the SPSC ring buffer.
+ *
+ * Must only be called from the single producer thread.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_push(ring_buffer_spsc_t *handle,
+                                           const void *element);
+
+/**
+ * @brief Pop an element from the SPSC ring buffer.
+ *
+ * Must only be called from the single consumer thread.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param element Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_pop(ring_buffer_spsc_t *handle,
+                                          void *element);
+
+/**
+ * @brief Set how many deferred pushes and pops are published at once.
+ *
+ * Must be called before the ring is shared between threads. A batch of 0
+ * (the default) means deferred operations are only published by
+ * ring_buffer_spsc_publish_head()/_tail(), by any other call of the same
+ * side, or when the ring looks full (push) or empty (pop).
+ *
+ * @param handle     Pointer to the ring buffer handle.
+ * @param push_batch Deferred pushes after which head is published.
+ * @param pop_batch  Deferred pops after which tail is published.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_spsc_set_publish_batch(ring_buffer_spsc_t *handle,
+                                   ring_buffer_index_t push_batch,
+                                   ring_buffer_index_t pop_batch);
+
+/**
+ * @brief Set how many slots ahead of head the producer prefetches for writing.
+ *
+ * Must be called before the ring is shared between threads. Every push then
+ * prefetches the cache lines distance slots ahead, so the read-for-ownership
+ * of a line the consumer just read overlaps with earlier pushes instead of
+ * stalling the write. A distance of 0 (the default) disables prefetching;
+ * a few cache lines' worth of slots is a good start.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param distance Slots ahead of head to prefetch (below the length).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_spsc_set_prefetch_distance(ring_buffer_spsc_t *handle,
+                                       ring_buffer_index_t distance);
+
+/**
+ * @brief Push an element without publishing it to the consumer yet.
+ *
+ * Producer side. Saves the cache line transfer of the head store on every
+ * element: head is only stored once push_batch elements are pending, when
+ * the ring looks full, or on ring_buffer_spsc_publish_head().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param element Pointer to the element to be pushed.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_push_deferred(ring_buffer_spsc_t *handle,
+                                                    const void *element);
+
+/**
+ * @brief Publish every deferred push to the consumer.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_publish_head(ring_buffer_spsc_t *handle);
+
+/**
+ * @brief Pop an element without handing its slot back to the producer yet.
+ *
+ * Consumer side. tail is only stored once pop_batch elements are pending,
+ * when the ring looks empty, or on ring_buffer_spsc_publish_tail().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param element Pointer where the popped element will be stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_pop_deferred(ring_buffer_spsc_t *handle,
+                                                   void *element);
+
+/**
+ * @brief Hand every slot freed by deferred pops back to the producer.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_publish_tail(ring_buffer_spsc_t *handle);
+
+/**
+ * @brief Push up to count elements into the SPSC ring buffer.
+ *
+ * Must only be called from the single producer thread. The batch is copied
+ * with at most two memcpy calls and published with a single head update.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param elements Pointer to count contiguous elements to be pushed.
+ * @param count    Number of elements available at elements.
+ * @param pushed   Pointer where the number of elements pushed is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if no element
+ * could be pushed).
+ */
+ring_buffer_status_t ring_buffer_spsc_push_n(ring_buffer_spsc_t *handle,
+                                             const void *elements,
+                                             ring_buffer_index_t count,
+                                             ring_buffer_index_t *pushed);
+
+/**
+ * @brief Push up to count elements, publishing only whole cache lines.
+ *
+ * Same as ring_buffer_spsc_push_n(), but head only advances to the start
+ * of the cache line that holds the new head: the elements of that partly
+ * written line stay deferred until a later push fills it, the ring becomes
+ * full, or ring_buffer_spsc_publish_head() is called. The consumer then
+ * never reads a line the producer is about to write again. Lines are
+ * counted from the start of the buffer, so it should be cache-line aligned
+ * and, ideally, the element size a RING_BUFFER_SLOT_PADDED_SIZE().
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param elements Pointer to count contiguous elements to be pushed.
+ * @param count    Number of elements available at elements.
+ * @param pushed   Pointer where the number of elements pushed is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if no element
+ * could be pushed).
+ */
+ring_buffer_status_t ring_buffer_spsc_push_lines(ring_buffer_spsc_t *handle,
+                                                 const void *elements,
+                                                 ring_buffer_index_t count,
+                                                 ring_buffer_index_t *pushed);
+
+/**
+ * @brief Pop up to count elements from the SPSC ring buffer.
+ *
+ * Must only be called from the single consumer thread. The batch is copied
+ * with at most two memcpy calls and released with a single tail update.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param elements Pointer where up to count elements will be stored.
+ * @param count    Maximum number of elements to pop.
+ * @param popped   Pointer where the number of elements popped is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if no element
+ * could be popped).
+ */
+ring_buffer_status_t ring_buffer_spsc_pop_n(ring_buffer_spsc_t *handle,
+                                            void *elements,
+                                            ring_buffer_index_t count,
+                                            ring_buffer_index_t *popped);
+
+/**
+ * @brief Reserve space at the head for zero-copy writes.
+ *
+ * Producer side. Returns a pointer straight into the buffer memory and the
+ * number of contiguous free elements behind it (never more than count).
+ * Nothing is visible to the consumer until ring_buffer_spsc_commit().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param count  Number of elements wanted.
+ * @param ptr    Pointer where the address of the first free slot is stored.
+ * @param contig Pointer where the number of usable elements is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL if no space).
+ */
+ring_buffer_status_t ring_buffer_spsc_reserve(ring_buffer_spsc_t *handle,
+                                              ring_buffer_index_t count,
+                                              void **ptr,
+                                              ring_buffer_index_t *contig);
+
+/**
+ * @brief Publish elements written through ring_buffer_spsc_reserve().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param count  Number of elements written (at most the reserved amount).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_commit(ring_buffer_spsc_t *handle,
+                                             ring_buffer_index_t count);
+
+/**
+ * @brief Access elements at the tail without copying them out.
+ *
+ * Consumer side. Returns a pointer straight into the buffer memory and the
+ * number of contiguous stored elements behind it (never more than count).
+ * The slots stay owned by the consumer until ring_buffer_spsc_release().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param count  Number of elements wanted.
+ * @param ptr    Pointer where the address of the oldest element is stored.
+ * @param contig Pointer where the number of readable elements is stored.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY if none).
+ */
+ring_buffer_status_t ring_buffer_spsc_peek(ring_buffer_spsc_t *handle,
+                                           ring_buffer_index_t count,
+                                           void **ptr,
+                                           ring_buffer_index_t *contig);
+
+/**
+ * @brief Drop elements accessed through ring_buffer_spsc_peek().
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param count  Number of elements consumed (at most the peeked amount).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_release(ring_buffer_spsc_t *handle,
+                                              ring_buffer_index_t count);
+
+/**
+ * @brief Drop every element currently in the SPSC ring buffer.
+ *
+ * Consumer side: tail is moved to the producer's latest head in one store,
+ * so the cost does not depend on the number of elements. Elements pushed
+ * concurrently after head was read are kept.
+ *
+ * @param handle  Pointer to the ring buffer handle.
+ * @param drained Pointer where the number of dropped elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_drain(ring_buffer_spsc_t *handle,
+                                            ring_buffer_index_t *drained);
+
+/**
+ * @brief Get the current state of the SPSC ring buffer.
+ *
+ * The result is a snapshot and may be stale by the time it is returned.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY,
+ * RING_BUFFER_FULL, or RING_BUFFER_OK).
+ */
+ring_buffer_status_t ring_buffer_spsc_state(const ring_buffer_spsc_t *handle);
+
+/**
+ * @brief Get the number of elements in the SPSC ring buffer.
+ *
+ * The result is a snapshot and may be stale by the time it is returned.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param size   Pointer where the number of elements is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_size(const ring_buffer_spsc_t *handle,
+                                           ring_buffer_index_t *size);
+
+/**
+ * @brief Get the number of elements the SPSC ring buffer can hold.
+ *
+ * @param handle   Pointer to the ring buffer handle.
+ * @param capacity Pointer where the capacity is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_spsc_capacity(const ring_buffer_spsc_t *handle,
+                          ring_buffer_index_t *capacity);
+
+/**
+ * @brief Take a snapshot of the SPSC ring buffer counters.
+ *
+ * Same contract as ring_buffer_stats(). The producer counters live on the
+ * producer's cache line and the consumer counters on the consumer's, so
+ * keeping them adds no cross-core traffic; the watermark is computed
+ * against the producer's cached tail and only refreshed when it would rise.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param stats  Pointer where the counters are stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_spsc_stats(const ring_buffer_spsc_t *handle,
+                                            ring_buffer_stats_t *stats);
+
+/**
+ * @brief Start timestamping elements to measure how long they are queued.
+ *
+ * Same contract as ring_buffer_set_latency_stamps(). The producer writes
+ * each slot's stamp before publishing it and the consumer reads it before
+ * handing the slot back, so no extra synchronization is needed. Call it
+ * before the producer and consumer threads start.
+ *
+ * @param handle Pointer to the ring buffer handle.
+ * @param stamps Pointer to one uint64_t per element of the buffer, or NULL.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_spsc_set_latency_stamps(ring_buffer_spsc_t *handle,
+                                    uint64_t *stamps);
+
+/**
+ * @brief Take a snapshot of the dwell-time histogram.
+ *
+ * Same contract as ring_buffer_latency(); the histogram lives on the
+ * consumer's cache line and may be read from any thread.
+ *
+ * @param handle  Pointer to the ring buffer handle.
+ * @param latency Pointer where the histogram is stored.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t
+ring_buffer_spsc_latency(const ring_buffer_spsc_t *handle,
+                         ring_buffer_latency_t *latency);
+
+#endif /* RING_BUFFER_SPSC_H_ */
@@ -0,0 +1,166 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_typed.h                                                  *
+ * Description:                                                               *
+ *     Macros generating ring buffers specialized at compile time for one     *
+ *     element type and one capacity.                                         *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_TYPED_H_
+#define RING_BUFFER_TYPED_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+
+/*
+ * RING_BUFFER_DEFINE(name, type, capacity)
+ *
+ * Defines name_t plus static inline name_init/name_push/name_pop/name_size.
+ * The element size and capacity are compile-time constants, so copies become
+ * plain loads/stores and the index wrap becomes a constant mask. capacity
+ * must be a power of two no larger than RING_BUFFER_INDEX_LENGTH_MAX; head,
+ * tail and the size are ring_buffer_index_t. Like ring_buffer_t, the
+ * generated ring is not thread-safe by itself; guard it with a lock when
+ * sharing it.
+ */
+#define RING_BUFFER_DEFINE(name, type, capacity)                               \
+    _Static_assert(((capacity) >= 2U) &&                                       \
+                       (((capacity) & ((capacity) - 1U)) == 0U),               \
+                   #name ": capacity must be a power of two");                 \
+    _Static_assert((capacity) <= RING_BUFFER_INDEX_LENGTH_MAX,                 \
+                   #name ": capacity does not fit ring_buffer_index_t");       \
+                                                                               \
+    typedef struct                                                             \
+    {                                                                          \
+        type buffer[capacity]; /* Element storage */                          \
+        ring_buffer_index_t head; /* Free-running write counter */            \
+        ring_buffer_index_t tail; /* Free-running read counter */             \
+    } name##_t;                                                                \
+                                                                               \
+    static inline void name##_init(name##_t *handle)                           \
+    {                                                                          \
+        handle->head = 0U;                                                     \
+        handle->tail = 0U;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline ring_buffer_index_t name##_size(const name##_t *handle)      \
+    {                                                                          \
+        return (ring_buffer_index_t)(handle->head - handle->tail);             \
+    }                                                                          \
+                                                                               \
+    static inline ring_buffer_status_t name##_push(name##_t *handle,           \
+                                                   const type *element)        \
+    {                                                                          \
+        if (name##_size(handle) == (ring_buffer_index_t)(capacity))            \
+        {                                                                      \
+            return RING_BUFFER_FULL;                                           \
+        }                                                                      \
+                                                                               \
+        handle->buffer[handle->head & ((capacity) - 1U)] = *element;           \
+        handle->head++;                                                        \
+                                                                               \
+        return RING_BUFFER_OK;                                                 \
+    }                                                                          \
+                                                                               \
+    static inline ring_buffer_status_t name##_pop(name##_t *handle,            \
+                                                  type *element)               \
+    {                                                                          \
+        if (handle->head == handle->tail)                                      \
+        {                                                                      \
+            return RING_BUFFER_EMPTY;                                          \
+        }                                                                      \
+                                                                               \
+        *element = handle->buffer[handle->tail & ((capacity) - 1U)];           \
+        handle->tail++;                                                        \
+                                                                               \
+        return RING_BUFFER_OK;                                                 \
+    }                                                                          \
+                                                                               \
+    typedef int name##_defined_ /* Swallows the trailing semicolon */
+
+/*
+ * RING_BUFFER_SPSC_DEFINE(name, type, capacity)
+ *
+ * Same as RING_BUFFER_DEFINE() but lock-free for one producer and one
+ * consumer thread: head and tail are C11 atomics on separate cache lines,
+ * published with release stores and read with acquire loads.
+ */
+#define RING_BUFFER_SPSC_DEFINE(name, type, capacity)                          \
+    _Static_assert(((capacity) >= 2U) &&                                       \
+                       (((capacity) & ((capacity) - 1U)) == 0U),               \
+                   #name ": capacity must be a power of two");                 \
+    _Static_assert((capacity) <= RING_BUFFER_INDEX_LENGTH_MAX,                 \
+                   #name ": capacity does not fit ring_buffer_index_t");       \
+                                                                               \
+    typedef struct                                                             \
+    {                                                                          \
+        type buffer[capacity]; /* Element storage */                          \
+        _Alignas(RING_BUFFER_CACHE_LINE_SIZE)                                  \
+        _Atomic ring_buffer_index_t head; /* Free-running write counter */    \
+        _Alignas(RING_BUFFER_CACHE_LINE_SIZE)                                  \
+        _Atomic ring_buffer_index_t tail; /* Free-running read counter */     \
+    } name##_t;                                                                \
+                                                                               \
+    static inline void name##_init(name##_t *handle)                           \
+    {                                                                          \
+        atomic_init(&handle->head, 0U);                                        \
+        atomic_init(&handle->tail, 0U);                                        \
+    }                                                                          \
+                                                                               \
+    static inline ring_buffer_index_t name##_size(const name##_t *handle)      \
+    {                                                                          \
+        ring_buffer_index_t tail =                                             \
+            atomic_load_explicit(&handle->tail, memory_order_acquire);         \
+        return (ring_buffer_index_t)(                                          \
+            atomic_load_explicit(&handle->head, memory_order_acquire) - tail); \
+    }                                                                          \
+                                                                               \
+    static inline ring_buffer_status_t name##_push(name##_t *handle,           \
+                                                   const type *element)        \
+    {                                                                          \
+        ring_buffer_index_t head =                                             \
+            atomic_load_explicit(&handle->head, memory_order_relaxed);         \
+                                                                               \
+        if ((ring_buffer_index_t)(head - atomic_load_explicit(                 \
+                &handle->tail, memory_order_acquire)) ==                       \
+            (ring_buffer_index_t)(capacity))                                   \
+        {                                                                      \
+            return RING_BUFFER_FULL;                                           \
+        }                                                                      \
+                                                                               \
+        handle->buffer[head & ((capacity) - 1U)] = *element;                   \
+        atomic_store_explicit(&handle->head, (ring_buffer_index_t)(head + 1U), \
+                              memory_order_release);                           \
+                                                                               \
+        return RING_BUFFER_OK;                                                 \
+    }                                                                          \
+                                                                               \
+    static inline ring_buffer_status_t name##_pop(name##_t *handle,            \
+                                                  type *element)               \
+    {                                                                          \
+        ring_buffer_index_t tail =                                             \
+            atomic_load_explicit(&handle->tail, memory_order_relaxed);         \
+                                                                               \
+        if (atomic_load_explicit(&handle->head, memory_order_acquire) == tail) \
+        {                                                                      \
+            return RING_BUFFER_EMPTY;                                          \
+        }                                                                      \
+                                                                               \
+        *element = handle->buffer[tail & ((capacity) - 1U)];                   \
+        atomic_store_explicit(&handle->tail, (ring_buffer_index_t)(tail + 1U), \
+                              memory_order_release);                           \
+                                                                               \
+        return RING_BUFFER_OK;                                                 \
+    }                                                                          \
+                                                                               \
+    typedef int name##_defined_ /* Swallows the trailing semicolon */
+
+#endif /* RING_BUFFER_TYPED_H_ */
@@ -0,0 +1,423 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_wait.c                                                   *
+ * Description:                                                               *
+ *     Implementation of the blocking push/pop operations for the SPSC        *
+ *     ring buffer.                                                           *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ring_buffer_wait.h"
+#include "ring_buffer_internal.h"
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+/* Outcomes of one step of the wait strategy */
+#define RING_BUFFER_WAIT_RETRY 0
+#define RING_BUFFER_WAIT_PARK 1
+#define RING_BUFFER_WAIT_EXPIRED 2
+
+/* Spins between two reads of the clock while a timeout is running */
+#define RING_BUFFER_WAIT_CLOCK_SPINS 64U
+
+/* Compute the absolute deadline for a relative timeout in milliseconds */
+static void ring_buffer_wait_deadline(int32_t timeout_ms,
+                                      struct timespec *deadline)
+{
+    (void)clock_gettime(CLOCK_MONOTONIC, deadline);
+
+    deadline->tv_sec += (time_t)(timeout_ms / 1000);
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+
+    if (deadline->tv_nsec >= 1000000000L)
+    {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/* Get the nanoseconds left before an absolute deadline (0 once passed) */
+static uint64_t ring_buffer_wait_remaining(const struct timespec *deadline)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int64_t left = (((int64_t)deadline->tv_sec - (int64_t)now.tv_sec) *
+                    1000000000) +
+                   ((int64_t)deadline->tv_nsec - (int64_t)now.tv_nsec);
+
+    return (left > 0) ? (uint64_t)left : 0U;
+}
+
+/* Sleep for the given sleep of the exponential backoff (0 is the first) */
+static void ring_buffer_wait_sleep(const ring_buffer_wait_strategy_t *strategy,
+                                   uint64_t sleep, uint64_t remaining)
+{
+    uint64_t ns = (remaining < strategy->sleep_max_ns) ? remaining
+                                                       : strategy->sleep_max_ns;
+
+    if (sleep < 32U)
+    {
+        uint64_t doubled = (uint64_t)strategy->sleep_min_ns << sleep;
+
+        ns = (doubled < ns) ? doubled : ns;
+    }
+
+    struct timespec delay = {(time_t)(ns / 1000000000U),
+                             (long)(ns % 1000000000U)};
+
+    (void)nanosleep(&delay, NULL);
+}
+
+/* Take step number step of the strategy before the operation is retried */
+static int ring_buffer_wait_step(const ring_buffer_wait_strategy_t *strategy,
+                                 uint32_t step, int32_t timeout_ms,
+                                 const struct timespec *deadline)
+{
+    uint64_t yields_end = (uint64_t)strategy->spin_count +
+                          strategy->yield_count;
+    uint64_t sleeps_end = yields_end + strategy->sleep_count;
+    int spinning = (step < strategy->spin_count) ||
+                   ((step >= sleeps_end) && (strategy->park == 0U) &&
+                    (strategy->sleep_count == 0U) &&
+                    (strategy->yield_count == 0U));
+    uint64_t remaining = UINT64_MAX;
+
+    /* Reading the clock would dominate a spin, so do it every few spins */
+    if ((timeout_ms > 0) &&
+        (!spinning || ((step % RING_BUFFER_WAIT_CLOCK_SPINS) == 0U)))
+    {
+        remaining = ring_buffer_wait_remaining(deadline);
+
+        if (remaining == 0U)
+        {
+            return RING_BUFFER_WAIT_EXPIRED;
+        }
+    }
+
+    if (spinning)
+    {
+        ring_buffer_cpu_relax();
+    }
+    else if (step < yields_end)
+    {
+        (void)sched_yield();
+    }
+    else if (step < sleeps_end)
+    {
+        ring_buffer_wait_sleep(strategy, step - yields_end, remaining);
+    }
+    else if (strategy->park != 0U)
+    {
+        return RING_BUFFER_WAIT_PARK;
+    }
+    else if (strategy->sleep_count != 0U)
+    {
+        /* Never parking: keep sleeping as long as the backoff allows */
+        ring_buffer_wait_sleep(strategy, UINT64_MAX, remaining);
+    }
+    else
+    {
+        (void)sched_yield();
+    }
+
+    return RING_BUFFER_WAIT_RETRY;
+}
+
+/* Park on cond until it is signalled or the deadline passes */
+static int ring_buffer_wait_park(ring_buffer_waiter_t *waiter,
+                                 pthread_cond_t *cond, int32_t timeout_ms,
+                                 const struct timespec *deadline)
+{
+    if (timeout_ms < 0)
+    {
+        return pthread_cond_wait(cond, &waiter->lock);
+    }
+
+    return pthread_cond_timedwait(cond, &waiter->lock, deadline);
+}
+
+/* Wake the other side, but only if it announced that it is parked */
+static void ring_buffer_wait_wake(ring_buffer_waiter_t *waiter,
+                                  _Atomic uint32_t *waiting,
+                                  pthread_cond_t *cond)
+{
+    /* Pairs with the fence after the waiter sets its flag */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(waiting, memory_order_relaxed) != 0U)
+    {
+        (void)pthread_mutex_lock(&waiter->lock);
+        (void)pthread_cond_signal(cond);
+        (void)pthread_mutex_unlock(&waiter->lock);
+    }
+}
+
+/* Attach blocking operations to an SPSC ring buffer */
+ring_buffer_status_t ring_buffer_waiter_init(ring_buffer_waiter_t *waiter,
+                                             ring_buffer_spsc_t *ring,
+                                             uint32_t spin_count)
+{
+    if ((waiter == NULL) || (ring == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (waiter->init_flag == RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_ALREADY_INITIALIZED;
+    }
+
+    if (ring->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    /* Clear the handle structure */
+    (void)memset(waiter, 0, sizeof(ring_buffer_waiter_t));
+
+    pthread_condattr_t attr;
+
+    if (pthread_condattr_init(&attr) != 0)
+    {
+        return RING_BUFFER_FAIL;
+    }
+
+    /* Timeouts must not jump with the wall clock */
+    (void)pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    if (pthread_mutex_init(&waiter->lock, NULL) != 0)
+    {
+        (void)pthread_condattr_destroy(&attr);
+        return RING_BUFFER_FAIL;
+    }
+
+    if (pthread_cond_init(&waiter->not_empty, &attr) != 0)
+    {
+        (void)pthread_mutex_destroy(&waiter->lock);
+        (void)pthread_condattr_destroy(&attr);
+        return RING_BUFFER_FAIL;
+    }
+
+    if (pthread_cond_init(&waiter->not_full, &attr) != 0)
+    {
+        (void)pthread_cond_destroy(&waiter->not_empty);
+        (void)pthread_mutex_destroy(&waiter->lock);
+        (void)pthread_condattr_destroy(&attr);
+        return RING_BUFFER_FAIL;
+    }
+
+    (void)pthread_condattr_destroy(&attr);
+
+    waiter->ring = ring;
+    waiter->strategy.spin_count = spin_count;
+    waiter->strategy.park = 1U;
+    atomic_init(&waiter->consumer_waiting, 0U);
+    atomic_init(&waiter->producer_waiting, 0U);
+    waiter->init_flag = RING_BUFFER_INITIALIZE_MASK;
+
+    return RING_BUFFER_OK;
+}
+
+/* Detach blocking operations from the ring buffer */
+ring_buffer_status_t ring_buffer_waiter_destroy(ring_buffer_waiter_t *waiter)
+{
+    if (waiter == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (waiter->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    (void)pthread_cond_destroy(&waiter->not_full);
+    (void)pthread_cond_destroy(&waiter->not_empty);
+    (void)pthread_mutex_destroy(&waiter->lock);
+
+    /* Clear the handle structure */
+    (void)memset(waiter, 0, sizeof(ring_buffer_waiter_t));
+
+    return RING_BUFFER_OK;
+}
+
+/* Select how the producer and the consumer of the ring wait */
+ring_buffer_status_t
+ring_buffer_waiter_set_strategy(ring_buffer_waiter_t *waiter,
+                                const ring_buffer_wait_strategy_t *strategy)
+{
+    if ((waiter == NULL) || (strategy == NULL))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (waiter->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    if ((strategy->sleep_count != 0U) &&
+        ((strategy->sleep_min_ns == 0U) ||
+         (strategy->sleep_min_ns > strategy->sleep_max_ns)))
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    waiter->strategy = *strategy;
+
+    return RING_BUFFER_OK;
+}
+
+/* Push an element, waiting for space if the ring is full */
+ring_buffer_status_t ring_buffer_push_wait(ring_buffer_waiter_t *waiter,
+                                           const void *element,
+                                           int32_t timeout_ms)
+{
+    if (waiter == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (waiter->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_status_t status = ring_buffer_spsc_push(waiter->ring, element);
+    struct timespec deadline = {0};
+    int outcome = RING_BUFFER_WAIT_RETRY;
+
+    if ((status == RING_BUFFER_FULL) && (timeout_ms > 0))
+    {
+        ring_buffer_wait_deadline(timeout_ms, &deadline);
+    }
+
+    /* A busy consumer usually frees a slot within the first steps */
+    for (uint32_t step = 0U; (status == RING_BUFFER_FULL) &&
+                             (timeout_ms != 0) &&
+                             (outcome == RING_BUFFER_WAIT_RETRY);
+         step += (step < UINT32_MAX) ? 1U : 0U)
+    {
+        outcome = ring_buffer_wait_step(&waiter->strategy, step, timeout_ms,
+                                        &deadline);
+
+        if (outcome == RING_BUFFER_WAIT_RETRY)
+        {
+            status = ring_buffer_spsc_push(waiter->ring, element);
+        }
+    }
+
+    if ((status == RING_BUFFER_FULL) && (outcome == RING_BUFFER_WAIT_PARK))
+    {
+        int rc = 0;
+
+        (void)pthread_mutex_lock(&waiter->lock);
+        atomic_store_explicit(&waiter->producer_waiting, 1U,
+                              memory_order_relaxed);
+
+        /* Pairs with the fence in ring_buffer_wait_wake() */
+        atomic_thread_fence(memory_order_seq_cst);
+        status = ring_buffer_spsc_push(waiter->ring, element);
+
+        while ((status == RING_BUFFER_FULL) && (rc != ETIMEDOUT))
+        {
+            rc = ring_buffer_wait_park(waiter, &waiter->not_full, timeout_ms,
+                                       &deadline);
+            status = ring_buffer_spsc_push(waiter->ring, element);
+        }
+
+        atomic_store_explicit(&waiter->producer_waiting, 0U,
+                              memory_order_relaxed);
+        (void)pthread_mutex_unlock(&waiter->lock);
+    }
+
+    if (status == RING_BUFFER_OK)
+    {
+        ring_buffer_wait_wake(waiter, &waiter->consumer_waiting,
+                              &waiter->not_empty);
+    }
+
+    return status;
+}
+
+/* Pop an element, waiting for data if the ring is empty */
+ring_buffer_status_t ring_buffer_pop_wait(ring_buffer_waiter_t *waiter,
+                                          void *element, int32_t timeout_ms)
+{
+    if (waiter == NULL)
+    {
+        return RING_BUFFER_INVALID_PARAMS;
+    }
+
+    if (waiter->init_flag != RING_BUFFER_INITIALIZE_MASK)
+    {
+        return RING_BUFFER_NOT_INITIALIZED;
+    }
+
+    ring_buffer_status_t status = ring_buffer_spsc_pop(waiter->ring, element);
+    struct timespec deadline = {0};
+    int outcome = RING_BUFFER_WAIT_RETRY;
+
+    if ((status == RING_BUFFER_EMPTY) && (timeout_ms > 0))
+    {
+        ring_buffer_wait_deadline(timeout_ms, &deadline);
+    }
+
+    /* A busy producer usually delivers within the first steps */
+    for (uint32_t step = 0U; (status == RING_BUFFER_EMPTY) &&
+                             (timeout_ms != 0) &&
+                             (outcome == RING_BUFFER_WAIT_RETRY);
+         step += (step < UINT32_MAX) ? 1U : 0U)
+    {
+        outcome = ring_buffer_wait_step(&waiter->strategy, step, timeout_ms,
+                                        &deadline);
+
+        if (outcome == RING_BUFFER_WAIT_RETRY)
+        {
+            status = ring_buffer_spsc_pop(waiter->ring, element);
+        }
+    }
+
+    if ((status == RING_BUFFER_EMPTY) && (outcome == RING_BUFFER_WAIT_PARK))
+    {
+        int rc = 0;
+
+        (void)pthread_mutex_lock(&waiter->lock);
+        atomic_store_explicit(&waiter->consumer_waiting, 1U,
+                              memory_order_relaxed);
+
+        /* Pairs with the fence in ring_buffer_wait_wake() */
+        atomic_thread_fence(memory_order_seq_cst);
+        status = ring_buffer_spsc_pop(waiter->ring, element);
+
+        while ((status == RING_BUFFER_EMPTY) && (rc != ETIMEDOUT))
+        {
+            rc = ring_buffer_wait_park(waiter, &waiter->not_empty, timeout_ms,
+                                       &deadline);
+            status = ring_buffer_spsc_pop(waiter->ring, element);
+        }
+
+        atomic_store_explicit(&waiter->consumer_waiting, 0U,
+                              memory_order_relaxed);
+        (void)pthread_mutex_unlock(&waiter->lock);
+    }
+
+    if (status == RING_BUFFER_OK)
+    {
+        ring_buffer_wait_wake(waiter, &waiter->producer_waiting,
+                              &waiter->not_full);
+    }
+
+    return status;
+}
@@ -0,0 +1,146 @@
+/******************************************************************************
+ *                                                                            *
+ *                         Ring Buffer Implementation                         *
+ *                                                                            *
+ * File: ring_buffer_wait.h                                                   *
+ * Description:                                                               *
+ *     Header file defining blocking push/pop operations on top of the        *
+ *     lock-free SPSC ring buffer.                                            *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef RING_BUFFER_WAIT_H_
+#define RING_BUFFER_WAIT_H_
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+
+/* Default number of retries before a waiting side parks */
+#define RING_BUFFER_WAIT_DEFAULT_SPIN 1024U
+
+/* Timeout value meaning "wait forever" */
+#define RING_BUFFER_WAIT_FOREVER (-1)
+
+/*
+ * How a side waits for the ring to stop being full/empty.
+ *
+ * The stages run in order, retrying the operation after each step:
+ * spin_count busy retries with a pause/yield instruction, yield_count
+ * sched_yield() calls, then sleep_count sleeps starting at sleep_min_ns
+ * and doubling up to sleep_max_ns, and finally parking on a condition
+ * variable. With park set to 0 the side never parks: the last enabled
+ * stage repeats until the operation succeeds or times out. A stage with
+ * a count of 0 is skipped, and no sleep runs past the timeout.
+ */
+typedef struct
+{
+    uint32_t spin_count;   /* Busy retries with a CPU pause */
+    uint32_t yield_count;  /* Retries after giving up the time slice */
+    uint32_t sleep_count;  /* Retries after an exponential sleep */
+    uint32_t sleep_min_ns; /* First sleep in nanoseconds */
+    uint32_t sleep_max_ns; /* Longest sleep in nanoseconds */
+    uint8_t park;          /* Park once the stages above are exhausted */
+} ring_buffer_wait_strategy_t;
+
+/*
+ * Structure attaching blocking operations to an SPSC ring buffer.
+ *
+ * A side that finds the ring full/empty goes through the stages of its
+ * strategy and then parks on a condition variable. The other side only
+ * takes the mutex to signal when the matching *_waiting flag says someone
+ * is parked, so the fast path stays lock-free. Both sides must go through
+ * this structure for wakeups to be delivered.
+ */
+typedef struct
+{
+    ring_buffer_spsc_t *ring;             /* Attached ring buffer */
+    pthread_mutex_t lock;                 /* Protects the park/wake handshake */
+    pthread_cond_t not_empty;             /* Signalled when data arrives */
+    pthread_cond_t not_full;              /* Signalled when space frees up */
+    _Atomic uint32_t consumer_waiting;    /* Consumer is parked */
+    _Atomic uint32_t producer_waiting;    /* Producer is parked */
+    ring_buffer_wait_strategy_t strategy; /* How both sides wait */
+    uint8_t init_flag;                    /* Initialization flag */
+} ring_buffer_waiter_t;
+
+/* Function prototypes */
+
+/**
+ * @brief Attach blocking operations to an SPSC ring buffer.
+ *
+ * The strategy spins spin_count times and then parks; change it with
+ * ring_buffer_waiter_set_strategy().
+ *
+ * @param waiter     Pointer to the waiter handle.
+ * @param ring       Pointer to an initialized SPSC ring buffer.
+ * @param spin_count Retries before parking (0 parks immediately).
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_waiter_init(ring_buffer_waiter_t *waiter,
+                                             ring_buffer_spsc_t *ring,
+                                             uint32_t spin_count);
+
+/**
+ * @brief Detach blocking operations from the ring buffer.
+ *
+ * No thread may be waiting when this is called.
+ *
+ * @param waiter Pointer to the waiter handle.
+ * @return ring_buffer_status_t Status code.
+ */
+ring_buffer_status_t ring_buffer_waiter_destroy(ring_buffer_waiter_t *waiter);
+
+/**
+ * @brief Select how the producer and the consumer of the ring wait.
+ *
+ * Must be called before the ring is shared between threads. Spinning
+ * without ever parking gives the lowest wakeup latency and burns a core;
+ * parking early saves the core and costs a system call on wakeup.
+ *
+ * @param waiter   Pointer to the waiter handle.
+ * @param strategy Pointer to the strategy to copy.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_INVALID_PARAMS if
+ * sleeps are enabled with sleep_min_ns 0 or above sleep_max_ns).
+ */
+ring_buffer_status_t
+ring_buffer_waiter_set_strategy(ring_buffer_waiter_t *waiter,
+                                const ring_buffer_wait_strategy_t *strategy);
+
+/**
+ * @brief Push an element, waiting for space if the ring is full.
+ *
+ * Producer side. A timeout of 0 behaves like ring_buffer_spsc_push() but
+ * still wakes a parked consumer.
+ *
+ * @param waiter     Pointer to the waiter handle.
+ * @param element    Pointer to the element to be pushed.
+ * @param timeout_ms Maximum time to wait in milliseconds, or
+ *                   RING_BUFFER_WAIT_FOREVER.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_FULL on timeout).
+ */
+ring_buffer_status_t ring_buffer_push_wait(ring_buffer_waiter_t *waiter,
+                                           const void *element,
+                                           int32_t timeout_ms);
+
+/**
+ * @brief Pop an element, waiting for data if the ring is empty.
+ *
+ * Consumer side. A timeout of 0 behaves like ring_buffer_spsc_pop() but
+ * still wakes a parked producer.
+ *
+ * @param waiter     Pointer to the waiter handle.
+ * @param element    Pointer where the popped element will be stored.
+ * @param timeout_ms Maximum time to wait in milliseconds, or
+ *                   RING_BUFFER_WAIT_FOREVER.
+ * @return ring_buffer_status_t Status code (RING_BUFFER_EMPTY on timeout).
+ */
+ring_buffer_status_t ring_buffer_pop_wait(ring_buffer_waiter_t *waiter,
+                                          void *element, int32_t timeout_ms);
+
+#endif /* RING_BUFFER_WAIT_H_ */
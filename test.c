@@ -0,0 +1,2559 @@
+/******************************************************************************
+ *                                                                            *
+ *                      Ring Buffer Concurrency Stress Test                   *
+ *                                                                            *
+ * File: test.c                                                               *
+ * Description:                                                               *
+ *     Randomized multi-threaded stress tests of every ring buffer variant,   *
+ *     checking each element for loss, duplication, reordering and torn       *
+ *     copies, with indices started just before their wraparound point,       *
+ *     after single-threaded checks of the other APIs and of past bugs.       *
+ *                                                                            *
+ * Author: Anderson Costa                                                     *
+ * Date: 2024-11-27                                                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include <unistd.h>
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_inline.h"
+#include "ring_buffer_mpmc.h"
+#include "ring_buffer_wait.h"
+#include "ring_buffer_typed.h"
+#include "ring_buffer_bytes.h"
+#include "ring_buffer_broadcast.h"
+#include "ring_buffer_sharded.h"
+#include "ring_buffer_notify.h"
+#include "ring_buffer_pool.h"
+#include "ring_buffer_shm.h"
+#include "ring_buffer_mirror.h"
+#include "ring_buffer_file.h"
+#include "ring_buffer_priority.h"
+
+/* Default number of messages sent by each producer */
+#define TEST_DEFAULT_MESSAGES 100000U
+
+/* Largest number of producer or consumer threads of a run */
+#define TEST_MAX_THREADS 4U
+
+/* Largest batch pushed or popped at once */
+#define TEST_MAX_BATCH 8U
+
+/* Ring lengths: a power of two and an odd one for the modulo paths */
+#define TEST_LENGTH 8U
+#define TEST_ODD_LENGTH 7U
+
+/* Capacity of the record ring in bytes */
+#define TEST_BYTES_CAPACITY 512U
+
+/* Largest filler appended to a record */
+#define TEST_BYTES_FILLER 40U
+
+/* Elements pushed before the free-running indices wrap around */
+#define TEST_WRAP_DISTANCE (3U * TEST_LENGTH)
+
+/*
+ * Non-power-of-two SPSC length above a third of the 16-bit index range, so
+ * that index + n no longer fits in the indices, which run up to twice it
+ */
+#define TEST_BULK_WRAP_LENGTH 30000U
+
+/* Failures reported in detail per run */
+#define TEST_MAX_REPORTS 8U
+
+/* Variant flags */
+#define TEST_BROADCAST 0x01U /* Every consumer receives every element */
+#define TEST_LOSSY 0x02U     /* Elements may be dropped, but are counted */
+#define TEST_UNCOUNTED 0x04U /* Lossy, but the ring does not count drops */
+
+/* Element sent through the rings */
+typedef struct
+{
+    uint64_t sequence; /* Position in the producer's stream */
+    uint32_t producer; /* Index of the producer thread */
+    uint32_t check;    /* Function of the fields above, detects torn copies */
+} test_element_t;
+
+/* Compile-time specialized ring */
+RING_BUFFER_SPSC_DEFINE(test_ring, test_element_t, TEST_LENGTH);
+
+/* State shared by the threads of one run */
+typedef struct
+{
+    ring_buffer_t ring;
+    ring_buffer_spsc_t spsc;
+    ring_buffer_mpmc_t mpmc;
+    ring_buffer_waiter_t waiter;
+    ring_buffer_notifier_t notifier;
+    ring_buffer_bytes_t bytes;
+    ring_buffer_broadcast_t broadcast;
+    ring_buffer_broadcast_cursor_t cursors[TEST_MAX_THREADS];
+    ring_buffer_sharded_t sharded;
+    ring_buffer_sharded_shard_t shards[TEST_MAX_THREADS];
+    ring_buffer_pool_t pool;
+    test_element_t objects[TEST_LENGTH];
+    test_ring_t typed;
+    ring_buffer_shm_t shm[2U * TEST_MAX_THREADS]; /* One mapping per thread */
+    char shm_name[32];
+    pthread_mutex_t mutex;
+    _Alignas(RING_BUFFER_CACHE_LINE_SIZE) uint8_t storage[4096];
+    uint32_t producers;
+    uint32_t consumers;
+    uint32_t deliveries; /* Consumers that must see each element */
+    uint32_t messages;   /* Messages sent by each producer */
+    uint64_t seed;
+    _Atomic uint8_t *seen; /* Deliveries of each (producer, sequence) */
+    _Atomic uint64_t received;
+    _Atomic uint64_t dropped;  /* Lost, overwritten or drained deliveries */
+    _Atomic uint32_t finished; /* Producers done pushing */
+    _Atomic uint32_t failures;
+} test_ctx_t;
+
+/* Operations implemented by every tested variant */
+typedef struct
+{
+    const char *name;
+    uint32_t producers;
+    uint32_t consumers;
+    uint32_t flags; /* Combination of TEST_* variant flags */
+    int (*setup)(test_ctx_t *ctx);
+    uint32_t (*push)(test_ctx_t *ctx, uint32_t producer,
+                     const test_element_t *elements, uint32_t count);
+    uint32_t (*pop)(test_ctx_t *ctx, uint32_t consumer,
+                    test_element_t *elements, uint32_t count);
+    void (*flush)(test_ctx_t *ctx, uint32_t producer); /* Or NULL */
+    void (*teardown)(test_ctx_t *ctx);
+} test_variant_t;
+
+static test_ctx_t test_ctx;
+
+/* xorshift64* step, good enough to shuffle batch sizes and yields */
+static inline uint64_t test_random(uint64_t *state)
+{
+    *state ^= *state >> 12U;
+    *state ^= *state << 25U;
+    *state ^= *state >> 27U;
+
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/* Value of the check field for an element */
+static inline uint32_t test_check(uint64_t sequence, uint32_t producer)
+{
+    return ~((uint32_t)sequence ^ (uint32_t)(sequence >> 32U)) ^
+           (producer * 0x9E3779B9U);
+}
+
+/* First position of the free-running indices, just before they wrap */
+static inline ring_buffer_index_t test_wrap_start(void)
+{
+    return (ring_buffer_index_t)(RING_BUFFER_INDEX_MAX -
+                                 (TEST_WRAP_DISTANCE - 1U));
+}
+
+/* Record a failure, describing the first few */
+static void test_fail(test_ctx_t *ctx, const char *what, uint32_t producer,
+                      uint64_t sequence)
+{
+    uint32_t failures = atomic_fetch_add(&ctx->failures, 1U);
+
+    if (failures < TEST_MAX_REPORTS)
+    {
+        printf("    %s: producer %u sequence %llu\n", what, producer,
+               (unsigned long long)sequence);
+    }
+}
+
+/* ---------------------- Index presets for wraparound --------------------- */
+
+/* Start an empty power-of-two ring_buffer_t just before the wrap point */
+static void test_wrap_ring(ring_buffer_t *ring)
+{
+    ring->head = test_wrap_start();
+    ring->tail = ring->head;
+}
+
+/* Start an empty power-of-two SPSC ring just before the wrap point */
+static void test_wrap_spsc(ring_buffer_spsc_t *spsc)
+{
+    ring_buffer_index_t start = test_wrap_start();
+
+    atomic_store_explicit(&spsc->head, start, memory_order_relaxed);
+    atomic_store_explicit(&spsc->tail, start, memory_order_relaxed);
+    spsc->local_head = start;
+    spsc->cached_tail = start;
+    spsc->local_tail = start;
+    spsc->cached_head = start;
+}
+
+/* Start an empty MPMC ring just before its sequence counters wrap */
+static void test_wrap_mpmc(ring_buffer_mpmc_t *mpmc)
+{
+    ring_buffer_mpmc_seq_t start =
+        (ring_buffer_mpmc_seq_t)0U - (ring_buffer_mpmc_seq_t)TEST_WRAP_DISTANCE;
+
+    atomic_store_explicit(&mpmc->head, start, memory_order_relaxed);
+    atomic_store_explicit(&mpmc->tail, start, memory_order_relaxed);
+
+    /* Slot of position p waits for a push at p */
+    for (ring_buffer_index_t i = 0U; i < mpmc->length; i++)
+    {
+        ring_buffer_mpmc_seq_t pos = start + i;
+        _Atomic ring_buffer_mpmc_seq_t *seq =
+            (_Atomic ring_buffer_mpmc_seq_t *)(void *)&mpmc
+                ->buffer[(size_t)(pos & mpmc->mask) * mpmc->slot_size];
+
+        atomic_store_explicit(seq, pos, memory_order_relaxed);
+    }
+}
+
+/* Start an empty shared-memory ring just before its positions wrap */
+static void test_wrap_shm(ring_buffer_shm_t *shm)
+{
+    uint32_t start = 0U - TEST_WRAP_DISTANCE;
+
+    atomic_store_explicit(&shm->header->head, start, memory_order_relaxed);
+    atomic_store_explicit(&shm->header->tail, start, memory_order_relaxed);
+    shm->cached_head = start;
+    shm->cached_tail = start;
+
+    if (shm->kind != RING_BUFFER_SHM_MPMC)
+    {
+        return;
+    }
+
+    /* Same slot protocol as test_wrap_mpmc() */
+    for (uint32_t i = 0U; i < shm->length; i++)
+    {
+        uint32_t pos = start + i;
+        _Atomic ring_buffer_shm_seq_t *seq =
+            (_Atomic ring_buffer_shm_seq_t *)(void *)&shm
+                ->data[(size_t)(pos & shm->mask) * shm->slot_size];
+
+        atomic_store_explicit(seq, pos, memory_order_relaxed);
+    }
+}
+
+/* ---------------------------- Mutex variants ----------------------------- */
+
+static int test_mutex_setup(test_ctx_t *ctx)
+{
+    (void)memset(&ctx->ring, 0, sizeof(ctx->ring));
+
+    return (ring_buffer_init(&ctx->ring, sizeof(test_element_t),
+                             TEST_ODD_LENGTH,
+                             ctx->storage) == RING_BUFFER_OK) ? 0 : -1;
+}
+
+static int test_mutex_pow2_setup(test_ctx_t *ctx)
+{
+    (void)memset(&ctx->ring, 0, sizeof(ctx->ring));
+
+    if (ring_buffer_init_pow2(&ctx->ring, sizeof(test_element_t),
+                              TEST_LENGTH, ctx->storage) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    test_wrap_ring(&ctx->ring);
+
+    return 0;
+}
+
+/* Length that fills the given number of mirror granules, or 0 if none */
+static ring_buffer_index_t test_mirror_length(uint32_t granules)
+{
+    return (ring_buffer_index_t)((ring_buffer_mirror_granularity() *
+                                  granules) /
+                                 sizeof(test_element_t));
+}
+
+static int test_mutex_mirror_setup(test_ctx_t *ctx)
+{
+    ring_buffer_alloc_options_t options = {RING_BUFFER_ALLOC_MIRRORED,
+                                           RING_BUFFER_ALLOC_ANY_NODE};
+
+    (void)memset(&ctx->ring, 0, sizeof(ctx->ring));
+
+    /* Three granules give a length that is not a power of two */
+    return (ring_buffer_create(&ctx->ring, sizeof(test_element_t),
+                               test_mirror_length(3U),
+                               &options) == RING_BUFFER_OK) ? 0 : -1;
+}
+
+static uint32_t test_mutex_push(test_ctx_t *ctx, uint32_t producer,
+                                const test_element_t *elements,
+                                uint32_t count)
+{
+    ring_buffer_index_t pushed = 0U;
+
+    (void)producer;
+    (void)pthread_mutex_lock(&ctx->mutex);
+    (void)ring_buffer_push_n(&ctx->ring, elements, count, &pushed);
+    (void)pthread_mutex_unlock(&ctx->mutex);
+
+    return pushed;
+}
+
+static uint32_t test_mutex_pop(test_ctx_t *ctx, uint32_t consumer,
+                               test_element_t *elements, uint32_t count)
+{
+    ring_buffer_index_t popped = 0U;
+
+    (void)consumer;
+    (void)pthread_mutex_lock(&ctx->mutex);
+    (void)ring_buffer_pop_n(&ctx->ring, elements, count, &popped);
+    (void)pthread_mutex_unlock(&ctx->mutex);
+
+    return popped;
+}
+
+static uint32_t test_inline_push(test_ctx_t *ctx, uint32_t producer,
+                                 const test_element_t *elements,
+                                 uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    (void)producer;
+    (void)pthread_mutex_lock(&ctx->mutex);
+
+    while ((pushed < count) &&
+           (ring_buffer_push_unchecked(&ctx->ring, &elements[pushed]) ==
+            RING_BUFFER_OK))
+    {
+        pushed++;
+    }
+
+    (void)pthread_mutex_unlock(&ctx->mutex);
+
+    return pushed;
+}
+
+static uint32_t test_inline_pop(test_ctx_t *ctx, uint32_t consumer,
+                                test_element_t *elements, uint32_t count)
+{
+    uint32_t popped = 0U;
+
+    (void)consumer;
+    (void)pthread_mutex_lock(&ctx->mutex);
+
+    while ((popped < count) &&
+           (ring_buffer_pop_unchecked(&ctx->ring, &elements[popped]) ==
+            RING_BUFFER_OK))
+    {
+        popped++;
+    }
+
+    (void)pthread_mutex_unlock(&ctx->mutex);
+
+    return popped;
+}
+
+static void test_mutex_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_destroy(&ctx->ring);
+}
+
+/* ----------------------------- SPSC variants ----------------------------- */
+
+static int test_spsc_setup(test_ctx_t *ctx)
+{
+    (void)memset(&ctx->spsc, 0, sizeof(ctx->spsc));
+
+    return (ring_buffer_spsc_init(&ctx->spsc, sizeof(test_element_t),
+                                  TEST_ODD_LENGTH,
+                                  ctx->storage) == RING_BUFFER_OK) ? 0 : -1;
+}
+
+static int test_spsc_pow2_setup(test_ctx_t *ctx)
+{
+    (void)memset(&ctx->spsc, 0, sizeof(ctx->spsc));
+
+    if (ring_buffer_spsc_init(&ctx->spsc, sizeof(test_element_t), TEST_LENGTH,
+                              ctx->storage) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    test_wrap_spsc(&ctx->spsc);
+
+    return 0;
+}
+
+static int test_spsc_mirror_setup(test_ctx_t *ctx)
+{
+    ring_buffer_alloc_options_t options = {RING_BUFFER_ALLOC_MIRRORED,
+                                           RING_BUFFER_ALLOC_ANY_NODE};
+
+    (void)memset(&ctx->spsc, 0, sizeof(ctx->spsc));
+
+    if (ring_buffer_spsc_create(&ctx->spsc, sizeof(test_element_t),
+                                test_mirror_length(1U),
+                                &options) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    test_wrap_spsc(&ctx->spsc);
+
+    return 0;
+}
+
+static int test_deferred_setup(test_ctx_t *ctx)
+{
+    if (test_spsc_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    return (ring_buffer_spsc_set_publish_batch(&ctx->spsc, 3U, 2U) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static int test_lines_setup(test_ctx_t *ctx)
+{
+    /* The odd length makes the buffer end in the middle of a cache line */
+    if (test_spsc_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    return (ring_buffer_spsc_set_prefetch_distance(&ctx->spsc, 3U) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static int test_lines_pow2_setup(test_ctx_t *ctx)
+{
+    if (test_spsc_pow2_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    return (ring_buffer_spsc_set_prefetch_distance(&ctx->spsc, 5U) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static uint32_t test_spsc_push(test_ctx_t *ctx, uint32_t producer,
+                               const test_element_t *elements, uint32_t count)
+{
+    ring_buffer_index_t pushed = 0U;
+
+    (void)producer;
+    (void)ring_buffer_spsc_push_n(&ctx->spsc, elements, count, &pushed);
+
+    return pushed;
+}
+
+static uint32_t test_spsc_pop(test_ctx_t *ctx, uint32_t consumer,
+                              test_element_t *elements, uint32_t count)
+{
+    ring_buffer_index_t popped = 0U;
+
+    (void)consumer;
+    (void)ring_buffer_spsc_pop_n(&ctx->spsc, elements, count, &popped);
+
+    return popped;
+}
+
+static uint32_t test_lines_push(test_ctx_t *ctx, uint32_t producer,
+                                const test_element_t *elements, uint32_t count)
+{
+    ring_buffer_index_t pushed = 0U;
+
+    (void)producer;
+    (void)ring_buffer_spsc_push_lines(&ctx->spsc, elements, count, &pushed);
+
+    return pushed;
+}
+
+static uint32_t test_spsc_inline_push(test_ctx_t *ctx, uint32_t producer,
+                                      const test_element_t *elements,
+                                      uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    (void)producer;
+
+    while ((pushed < count) &&
+           (ring_buffer_spsc_push_unchecked(&ctx->spsc, &elements[pushed]) ==
+            RING_BUFFER_OK))
+    {
+        pushed++;
+    }
+
+    return pushed;
+}
+
+static uint32_t test_spsc_inline_pop(test_ctx_t *ctx, uint32_t consumer,
+                                     test_element_t *elements, uint32_t count)
+{
+    uint32_t popped = 0U;
+
+    (void)consumer;
+
+    while ((popped < count) &&
+           (ring_buffer_spsc_pop_unchecked(&ctx->spsc, &elements[popped]) ==
+            RING_BUFFER_OK))
+    {
+        popped++;
+    }
+
+    return popped;
+}
+
+static uint32_t test_zero_copy_push(test_ctx_t *ctx, uint32_t producer,
+                                    const test_element_t *elements,
+                                    uint32_t count)
+{
+    void *slots;
+    ring_buffer_index_t contig = 0U;
+
+    (void)producer;
+
+    if (ring_buffer_spsc_reserve(&ctx->spsc, count, &slots, &contig) !=
+        RING_BUFFER_OK)
+    {
+        return 0U;
+    }
+
+    (void)memcpy(slots, elements, (size_t)contig * sizeof(test_element_t));
+    (void)ring_buffer_spsc_commit(&ctx->spsc, contig);
+
+    return contig;
+}
+
+static uint32_t test_zero_copy_pop(test_ctx_t *ctx, uint32_t consumer,
+                                   test_element_t *elements, uint32_t count)
+{
+    void *slots;
+    ring_buffer_index_t contig = 0U;
+
+    (void)consumer;
+
+    if (ring_buffer_spsc_peek(&ctx->spsc, count, &slots, &contig) !=
+        RING_BUFFER_OK)
+    {
+        return 0U;
+    }
+
+    (void)memcpy(elements, slots, (size_t)contig * sizeof(test_element_t));
+    (void)ring_buffer_spsc_release(&ctx->spsc, contig);
+
+    return contig;
+}
+
+/* Drop whatever is queued on one pop in TEST_MAX_BATCH */
+static uint32_t test_spsc_drain_pop(test_ctx_t *ctx, uint32_t consumer,
+                                    test_element_t *elements, uint32_t count)
+{
+    ring_buffer_index_t drained = 0U;
+
+    if (count != TEST_MAX_BATCH)
+    {
+        return test_spsc_pop(ctx, consumer, elements, count);
+    }
+
+    (void)ring_buffer_spsc_drain(&ctx->spsc, &drained);
+    (void)atomic_fetch_add(&ctx->dropped, drained);
+
+    return 0U;
+}
+
+static uint32_t test_deferred_push(test_ctx_t *ctx, uint32_t producer,
+                                   const test_element_t *elements,
+                                   uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    (void)producer;
+
+    while ((pushed < count) &&
+           (ring_buffer_spsc_push_deferred(&ctx->spsc, &elements[pushed]) ==
+            RING_BUFFER_OK))
+    {
+        pushed++;
+    }
+
+    return pushed;
+}
+
+static uint32_t test_deferred_pop(test_ctx_t *ctx, uint32_t consumer,
+                                  test_element_t *elements, uint32_t count)
+{
+    uint32_t popped = 0U;
+
+    (void)consumer;
+
+    while ((popped < count) &&
+           (ring_buffer_spsc_pop_deferred(&ctx->spsc, &elements[popped]) ==
+            RING_BUFFER_OK))
+    {
+        popped++;
+    }
+
+    return popped;
+}
+
+static void test_deferred_flush(test_ctx_t *ctx, uint32_t producer)
+{
+    (void)producer;
+    (void)ring_buffer_spsc_publish_head(&ctx->spsc);
+}
+
+static void test_spsc_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_spsc_destroy(&ctx->spsc);
+}
+
+/* --------------------------- Blocking variants --------------------------- */
+
+static int test_wait_setup(test_ctx_t *ctx)
+{
+    if (test_spsc_pow2_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    (void)memset(&ctx->waiter, 0, sizeof(ctx->waiter));
+
+    /* A short spin makes both sides park often */
+    return (ring_buffer_waiter_init(&ctx->waiter, &ctx->spsc, 4U) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static uint32_t test_wait_push(test_ctx_t *ctx, uint32_t producer,
+                               const test_element_t *elements, uint32_t count)
+{
+    (void)producer;
+    (void)count;
+
+    return (ring_buffer_push_wait(&ctx->waiter, elements,
+                                  RING_BUFFER_WAIT_FOREVER) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static uint32_t test_wait_pop(test_ctx_t *ctx, uint32_t consumer,
+                              test_element_t *elements, uint32_t count)
+{
+    (void)consumer;
+    (void)count;
+
+    return (ring_buffer_pop_wait(&ctx->waiter, elements,
+                                 RING_BUFFER_WAIT_FOREVER) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static int test_backoff_setup(test_ctx_t *ctx)
+{
+    /* Spin, yield and sleep, but never park: the waits poll the ring */
+    const ring_buffer_wait_strategy_t strategy = {16U, 4U, 4U, 1000U, 8000U,
+                                                  0U};
+
+    if (test_wait_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    return (ring_buffer_waiter_set_strategy(&ctx->waiter, &strategy) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+static void test_wait_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_waiter_destroy(&ctx->waiter);
+    test_spsc_teardown(ctx);
+}
+
+static int test_notify_setup(test_ctx_t *ctx)
+{
+    if (test_spsc_pow2_setup(ctx) != 0)
+    {
+        return -1;
+    }
+
+    (void)memset(&ctx->notifier, 0, sizeof(ctx->notifier));
+
+    return (ring_buffer_notifier_init(&ctx->notifier, &ctx->spsc) ==
+            RING_BUFFER_OK) ? 0 : -1;
+}
+
+/* Wait briefly for a notifier descriptor to become readable */
+static void test_notify_poll(int fd)
+{
+    struct pollfd pfd = {fd, POLLIN, 0};
+
+    (void)poll(&pfd, 1U, 10);
+}
+
+static uint32_t test_notify_push(test_ctx_t *ctx, uint32_t producer,
+                                 const test_element_t *elements,
+                                 uint32_t count)
+{
+    (void)producer;
+    (void)count;
+
+    if (ring_buffer_push_notify(&ctx->notifier, elements) == RING_BUFFER_OK)
+    {
+        return 1U;
+    }
+
+    int fd;
+
+    (void)ring_buffer_notifier_writable_fd(&ctx->notifier, &fd);
+    test_notify_poll(fd);
+
+    return 0U;
+}
+
+static uint32_t test_notify_pop(test_ctx_t *ctx, uint32_t consumer,
+                                test_element_t *elements, uint32_t count)
+{
+    (void)consumer;
+    (void)count;
+
+    if (ring_buffer_pop_notify(&ctx->notifier, elements) == RING_BUFFER_OK)
+    {
+        return 1U;
+    }
+
+    int fd;
+
+    (void)ring_buffer_notifier_readable_fd(&ctx->notifier, &fd);
+    test_notify_poll(fd);
+
+    return 0U;
+}
+
+static void test_notify_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_notifier_destroy(&ctx->notifier);
+    test_spsc_teardown(ctx);
+}
+
+/* ------------------------------ MPMC variant ----------------------------- */
+
+static int test_mpmc_setup(test_ctx_t *ctx)
+{
+    (void)memset(&ctx->mpmc, 0, sizeof(ctx->mpmc));
+
+    if (ring_buffer_mpmc_init(&ctx->mpmc, sizeof(test_element_t), TEST_LENGTH,
+                              ctx->storage) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    test_wrap_mpmc(&ctx->mpmc);
+
+    return 0;
+}
+
+static uint32_t test_mpmc_push(test_ctx_t *ctx, uint32_t producer,
+                               const test_element_t *elements, uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    (void)producer;
+
+    while ((pushed < count) &&
+           (ring_buffer_mpmc_push(&ctx->mpmc, &elements[pushed]) ==
+            RING_BUFFER_OK))
+    {
+        pushed++;
+    }
+
+    return pushed;
+}
+
+static uint32_t test_mpmc_pop(test_ctx_t *ctx, uint32_t consumer,
+                              test_element_t *elements, uint32_t count)
+{
+    uint32_t popped = 0U;
+
+    (void)consumer;
+
+    while ((popped < count) &&
+           (ring_buffer_mpmc_pop(&ctx->mpmc, &elements[popped]) ==
+            RING_BUFFER_OK))
+    {
+        popped++;
+    }
+
+    return popped;
+}
+
+/* Never fails: the oldest elements make room and are counted as dropped */
+static uint32_t test_overwrite_push(test_ctx_t *ctx, uint32_t producer,
+                                    const test_element_t *elements,
+                                    uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    (void)producer;
+
+    while (pushed < count)
+    {
+        ring_buffer_index_t dropped = 0U;
+
+        if (ring_buffer_mpmc_push_overwrite(&ctx->mpmc, &elements[pushed],
+                                            &dropped) != RING_BUFFER_OK)
+        {
+            break;
+        }
+
+        (void)atomic_fetch_add(&ctx->dropped, dropped);
+        pushed++;
+    }
+
+    return pushed;
+}
+
+/* Drop whatever is queued on one pop in TEST_MAX_BATCH */
+static uint32_t test_mpmc_drain_pop(test_ctx_t *ctx, uint32_t consumer,
+                                    test_element_t *elements, uint32_t count)
+{
+    ring_buffer_index_t drained = 0U;
+
+    if (count != TEST_MAX_BATCH)
+    {
+        return test_mpmc_pop(ctx, consumer, elements, count);
+    }
+
+    (void)ring_buffer_mpmc_drain(&ctx->mpmc, &drained);
+    (void)atomic_fetch_add(&ctx->dropped, drained);
+
+    return 0U;
+}
+
+static void test_mpmc_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_mpmc_destroy(&ctx->mpmc);
+}
+
+/* ----------------------------- Typed variant ----------------------------- */
+
+static int test_typed_setup(test_ctx_t *ctx)
+{
+    ring_buffer_index_t start = test_wrap_start();
+
+    test_ring_init(&ctx->typed);
+    atomic_store_explicit(&ctx->typed.head, start, memory_order_relaxed);
+    atomic_store_explicit(&ctx->typed.tail, start, memory_order_relaxed);
+
+    return 0;
+}
+
+static uint32_t test_typed_push(test_ctx_t *ctx, uint32_t producer,
+                                const test_element_t *elements,
+                                uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    (void)producer;
+
+    while ((pushed < count) &&
+           (test_ring_push(&ctx->typed, &elements[pushed]) ==
+            RING_BUFFER_OK))
+    {
+        pushed++;
+    }
+
+    return pushed;
+}
+
+static uint32_t test_typed_pop(test_ctx_t *ctx, uint32_t consumer,
+                               test_element_t *elements, uint32_t count)
+{
+    uint32_t popped = 0U;
+
+    (void)consumer;
+
+    while ((popped < count) &&
+           (test_ring_pop(&ctx->typed, &elements[popped]) == RING_BUFFER_OK))
+    {
+        popped++;
+    }
+
+    return popped;
+}
+
+static void test_typed_teardown(test_ctx_t *ctx)
+{
+    (void)ctx;
+}
+
+/* ---------------------------- Record variant ----------------------------- */
+
+static int test_bytes_setup(test_ctx_t *ctx)
+{
+    uint32_t start = 0U - (3U * TEST_BYTES_CAPACITY);
+
+    (void)memset(&ctx->bytes, 0, sizeof(ctx->bytes));
+
+    if (ring_buffer_bytes_init(&ctx->bytes, TEST_BYTES_CAPACITY,
+                               ctx->storage) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    atomic_store_explicit(&ctx->bytes.head, start, memory_order_relaxed);
+    atomic_store_explicit(&ctx->bytes.tail, start, memory_order_relaxed);
+    ctx->bytes.cached_tail = start;
+    ctx->bytes.cached_head = start;
+
+    return 0;
+}
+
+/* Size of the record carrying an element: the sequence picks the filler */
+static inline uint32_t test_bytes_size(uint64_t sequence)
+{
+    return (uint32_t)sizeof(test_element_t) +
+           (uint32_t)(sequence % (TEST_BYTES_FILLER + 1U));
+}
+
+static uint32_t test_bytes_push(test_ctx_t *ctx, uint32_t producer,
+                                const test_element_t *elements,
+                                uint32_t count)
+{
+    uint32_t size = test_bytes_size(elements->sequence);
+    uint8_t *data;
+
+    (void)producer;
+    (void)count;
+
+    if (ring_buffer_bytes_reserve(&ctx->bytes, size, (void **)&data) !=
+        RING_BUFFER_OK)
+    {
+        return 0U;
+    }
+
+    (void)memcpy(data, elements, sizeof(test_element_t));
+
+    for (uint32_t i = (uint32_t)sizeof(test_element_t); i < size; i++)
+    {
+        data[i] = (uint8_t)(elements->sequence + i);
+    }
+
+    (void)ring_buffer_bytes_commit(&ctx->bytes, size);
+
+    return 1U;
+}
+
+static uint32_t test_bytes_pop(test_ctx_t *ctx, uint32_t consumer,
+                               test_element_t *elements, uint32_t count)
+{
+    uint8_t *data;
+    uint32_t size;
+
+    (void)consumer;
+    (void)count;
+
+    if (ring_buffer_bytes_peek(&ctx->bytes, (void **)&data, &size) !=
+        RING_BUFFER_OK)
+    {
+        return 0U;
+    }
+
+    int intact = (size >= sizeof(test_element_t));
+
+    if (intact)
+    {
+        (void)memcpy(elements, data, sizeof(test_element_t));
+        intact = (size == test_bytes_size(elements->sequence));
+
+        for (uint32_t i = (uint32_t)sizeof(test_element_t);
+             intact && (i < size); i++)
+        {
+            intact = (data[i] == (uint8_t)(elements->sequence + i));
+        }
+    }
+
+    if (!intact)
+    {
+        /* Let the checker report it as a torn element */
+        elements->check = ~test_check(elements->sequence, elements->producer);
+    }
+
+    (void)ring_buffer_bytes_release(&ctx->bytes);
+
+    return 1U;
+}
+
+/* Drop whatever is queued on one pop in TEST_MAX_BATCH */
+static uint32_t test_bytes_drain_pop(test_ctx_t *ctx, uint32_t consumer,
+                                     test_element_t *elements, uint32_t count)
+{
+    if (count != TEST_MAX_BATCH)
+    {
+        return test_bytes_pop(ctx, consumer, elements, count);
+    }
+
+    (void)ring_buffer_bytes_drain(&ctx->bytes);
+
+    return 0U;
+}
+
+static void test_bytes_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_bytes_destroy(&ctx->bytes);
+}
+
+/* --------------------------- Broadcast variant --------------------------- */
+
+/* Initialize the broadcast ring just before its positions wrap */
+static int test_broadcast_init(test_ctx_t *ctx, uint32_t flags)
+{
+    ring_buffer_index_t start = test_wrap_start();
+
+    (void)memset(&ctx->broadcast, 0, sizeof(ctx->broadcast));
+
+    if (ring_buffer_broadcast_init(&ctx->broadcast, sizeof(test_element_t),
+                                   TEST_LENGTH, ctx->storage, ctx->cursors,
+                                   ctx->consumers, flags) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    atomic_store_explicit(&ctx->broadcast.head, start, memory_order_relaxed);
+    atomic_store_explicit(&ctx->broadcast.claim, start, memory_order_relaxed);
+    ctx->broadcast.cached_min = start;
+
+    for (uint32_t i = 0U; i < ctx->consumers; i++)
+    {
+        atomic_store_explicit(&ctx->cursors[i].position, start,
+                              memory_order_relaxed);
+        ctx->cursors[i].cached_head = start;
+    }
+
+    return 0;
+}
+
+static int test_broadcast_setup(test_ctx_t *ctx)
+{
+    return test_broadcast_init(ctx, 0U);
+}
+
+static int test_lossy_setup(test_ctx_t *ctx)
+{
+    return test_broadcast_init(ctx, RING_BUFFER_BROADCAST_LOSSY);
+}
+
+static uint32_t test_broadcast_push(test_ctx_t *ctx, uint32_t producer,
+                                    const test_element_t *elements,
+                                    uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    (void)producer;
+
+    while ((pushed < count) &&
+           (ring_buffer_broadcast_push(&ctx->broadcast, &elements[pushed]) ==
+            RING_BUFFER_OK))
+    {
+        pushed++;
+    }
+
+    return pushed;
+}
+
+static uint32_t test_broadcast_pop(test_ctx_t *ctx, uint32_t consumer,
+                                   test_element_t *elements, uint32_t count)
+{
+    uint32_t popped = 0U;
+    ring_buffer_index_t lost = 0U;
+
+    while ((popped < count) &&
+           (ring_buffer_broadcast_pop(&ctx->broadcast, consumer,
+                                      &elements[popped],
+                                      &lost) == RING_BUFFER_OK))
+    {
+        if (lost != 0U)
+        {
+            test_fail(ctx, "lost by a non-lossy broadcast", consumer, lost);
+        }
+
+        popped++;
+    }
+
+    return popped;
+}
+
+/* Count what an overrun consumer skipped; torn copies fail the check */
+static uint32_t test_lossy_pop(test_ctx_t *ctx, uint32_t consumer,
+                               test_element_t *elements, uint32_t count)
+{
+    uint32_t popped = 0U;
+    ring_buffer_index_t lost = 0U;
+
+    while (popped < count)
+    {
+        ring_buffer_status_t status = ring_buffer_broadcast_pop(
+            &ctx->broadcast, consumer, &elements[popped], &lost);
+
+        /* An overrun is reported even if the pop then finds it empty */
+        (void)atomic_fetch_add(&ctx->dropped, lost);
+
+        if (status != RING_BUFFER_OK)
+        {
+            break;
+        }
+
+        popped++;
+    }
+
+    return popped;
+}
+
+static void test_broadcast_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_broadcast_destroy(&ctx->broadcast);
+}
+
+/* ---------------------------- Sharded variant ---------------------------- */
+
+static int test_sharded_setup(test_ctx_t *ctx)
+{
+    (void)memset(&ctx->sharded, 0, sizeof(ctx->sharded));
+
+    if (ring_buffer_sharded_init(&ctx->sharded, sizeof(test_element_t),
+                                 TEST_LENGTH, ctx->shards, ctx->producers,
+                                 ctx->storage) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0U; i < ctx->producers; i++)
+    {
+        test_wrap_spsc(&ctx->shards[i].ring);
+    }
+
+    return 0;
+}
+
+static uint32_t test_sharded_push(test_ctx_t *ctx, uint32_t producer,
+                                  const test_element_t *elements,
+                                  uint32_t count)
+{
+    ring_buffer_index_t pushed = 0U;
+
+    (void)ring_buffer_sharded_push_n(&ctx->sharded, producer, elements, count,
+                                     &pushed);
+
+    return pushed;
+}
+
+static uint32_t test_sharded_pop(test_ctx_t *ctx, uint32_t consumer,
+                                 test_element_t *elements, uint32_t count)
+{
+    ring_buffer_index_t popped = 0U;
+
+    (void)ring_buffer_sharded_pop_n(&ctx->sharded, consumer, elements, count,
+                                    &popped);
+
+    return popped;
+}
+
+static void test_sharded_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_sharded_destroy(&ctx->sharded);
+}
+
+/* ------------------------------ Pool variant ----------------------------- */
+
+static int test_pool_setup(test_ctx_t *ctx)
+{
+    (void)memset(&ctx->pool, 0, sizeof(ctx->pool));
+
+    return (ring_buffer_pool_init(&ctx->pool, ctx->objects,
+                                  sizeof(test_element_t), TEST_LENGTH,
+                                  ctx->storage) == RING_BUFFER_OK) ? 0 : -1;
+}
+
+static uint32_t test_pool_push(test_ctx_t *ctx, uint32_t producer,
+                               const test_element_t *elements, uint32_t count)
+{
+    void *object;
+
+    (void)producer;
+    (void)count;
+
+    if (ring_buffer_pool_acquire(&ctx->pool, &object) != RING_BUFFER_OK)
+    {
+        return 0U;
+    }
+
+    (void)memcpy(object, elements, sizeof(test_element_t));
+
+    return (ring_buffer_pool_submit(&ctx->pool, object) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static uint32_t test_pool_pop(test_ctx_t *ctx, uint32_t consumer,
+                              test_element_t *elements, uint32_t count)
+{
+    void *object;
+
+    (void)consumer;
+    (void)count;
+
+    if (ring_buffer_pool_receive(&ctx->pool, &object) != RING_BUFFER_OK)
+    {
+        return 0U;
+    }
+
+    (void)memcpy(elements, object, sizeof(test_element_t));
+
+    /* Scribble over the object so a second owner would be noticed */
+    (void)memset(object, 0xA5, sizeof(test_element_t));
+
+    return (ring_buffer_pool_recycle(&ctx->pool, object) == RING_BUFFER_OK)
+               ? 1U : 0U;
+}
+
+static void test_pool_teardown(test_ctx_t *ctx)
+{
+    (void)ring_buffer_pool_destroy(&ctx->pool);
+}
+
+/* ------------------------- Shared-memory variants ------------------------ */
+
+static void test_shm_teardown(test_ctx_t *ctx)
+{
+    for (uint32_t i = 0U; i < (2U * TEST_MAX_THREADS); i++)
+    {
+        if (ctx->shm[i].header != NULL)
+        {
+            (void)ring_buffer_shm_detach(&ctx->shm[i]);
+        }
+    }
+}
+
+/* Producer p uses mapping p, consumer c mapping TEST_MAX_THREADS + c */
+static int test_shm_init(test_ctx_t *ctx, ring_buffer_shm_kind_t kind)
+{
+    int status = 0;
+
+    (void)snprintf(ctx->shm_name, sizeof(ctx->shm_name),
+                   "/ring_buffer_test_%ld", (long)getpid());
+
+    /* A crashed run may have left its segment behind */
+    (void)ring_buffer_shm_unlink(ctx->shm_name);
+
+    if (ring_buffer_shm_create(&ctx->shm[0], ctx->shm_name, kind,
+                               sizeof(test_element_t),
+                               TEST_LENGTH) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    test_wrap_shm(&ctx->shm[0]);
+
+    /* Each thread maps the segment at its own address */
+    for (uint32_t i = 1U; (status == 0) && (i < (2U * TEST_MAX_THREADS));
+         i++)
+    {
+        int used = (i < TEST_MAX_THREADS)
+                       ? (i < ctx->producers)
+                       : ((i - TEST_MAX_THREADS) < ctx->consumers);
+
+        if (used &&
+            (ring_buffer_shm_attach(&ctx->shm[i], ctx->shm_name) !=
+             RING_BUFFER_OK))
+        {
+            status = -1;
+        }
+    }
+
+    /* The mappings keep the segment alive */
+    (void)ring_buffer_shm_unlink(ctx->shm_name);
+
+    if (status != 0)
+    {
+        test_shm_teardown(ctx);
+    }
+
+    return status;
+}
+
+static int test_shm_spsc_setup(test_ctx_t *ctx)
+{
+    return test_shm_init(ctx, RING_BUFFER_SHM_SPSC);
+}
+
+static int test_shm_mpmc_setup(test_ctx_t *ctx)
+{
+    return test_shm_init(ctx, RING_BUFFER_SHM_MPMC);
+}
+
+static uint32_t test_shm_push(test_ctx_t *ctx, uint32_t producer,
+                              const test_element_t *elements, uint32_t count)
+{
+    uint32_t pushed = 0U;
+
+    while ((pushed < count) &&
+           (ring_buffer_shm_push(&ctx->shm[producer], &elements[pushed]) ==
+            RING_BUFFER_OK))
+    {
+        pushed++;
+    }
+
+    return pushed;
+}
+
+static uint32_t test_shm_pop(test_ctx_t *ctx, uint32_t consumer,
+                             test_element_t *elements, uint32_t count)
+{
+    ring_buffer_shm_t *shm = &ctx->shm[TEST_MAX_THREADS + consumer];
+    uint32_t popped = 0U;
+
+    while ((popped < count) &&
+           (ring_buffer_shm_pop(shm, &elements[popped]) == RING_BUFFER_OK))
+    {
+        popped++;
+    }
+
+    return popped;
+}
+
+/* Table of tested variants */
+static const test_variant_t test_variants[] = {
+    {"mutex", 2U, 2U, 0U, test_mutex_setup, test_mutex_push, test_mutex_pop,
+     NULL, test_mutex_teardown},
+    {"mutex-pow2", 2U, 2U, 0U, test_mutex_pow2_setup, test_mutex_push,
+     test_mutex_pop, NULL, test_mutex_teardown},
+    {"mutex-inline", 2U, 2U, 0U, test_mutex_pow2_setup, test_inline_push,
+     test_inline_pop, NULL, test_mutex_teardown},
+    {"spsc", 1U, 1U, 0U, test_spsc_setup, test_spsc_push, test_spsc_pop, NULL,
+     test_spsc_teardown},
+    {"spsc-pow2", 1U, 1U, 0U, test_spsc_pow2_setup, test_spsc_push,
+     test_spsc_pop, NULL, test_spsc_teardown},
+    {"spsc-inline", 1U, 1U, 0U, test_spsc_pow2_setup, test_spsc_inline_push,
+     test_spsc_inline_pop, NULL, test_spsc_teardown},
+    {"spsc-zero-copy", 1U, 1U, 0U, test_spsc_pow2_setup, test_zero_copy_push,
+     test_zero_copy_pop, NULL, test_spsc_teardown},
+    {"spsc-deferred", 1U, 1U, 0U, test_deferred_setup, test_deferred_push,
+     test_deferred_pop, test_deferred_flush, test_spsc_teardown},
+    {"spsc-lines", 1U, 1U, 0U, test_lines_setup, test_lines_push,
+     test_spsc_pop, test_deferred_flush, test_spsc_teardown},
+    {"spsc-lines-pow2", 1U, 1U, 0U, test_lines_pow2_setup, test_lines_push,
+     test_spsc_pop, test_deferred_flush, test_spsc_teardown},
+    {"spsc-wait", 1U, 1U, 0U, test_wait_setup, test_wait_push, test_wait_pop,
+     NULL, test_wait_teardown},
+    {"spsc-backoff", 1U, 1U, 0U, test_backoff_setup, test_wait_push,
+     test_wait_pop, NULL, test_wait_teardown},
+    {"spsc-notify", 1U, 1U, 0U, test_notify_setup, test_notify_push,
+     test_notify_pop, NULL, test_notify_teardown},
+    {"typed-spsc", 1U, 1U, 0U, test_typed_setup, test_typed_push,
+     test_typed_pop, NULL, test_typed_teardown},
+    {"bytes", 1U, 1U, 0U, test_bytes_setup, test_bytes_push, test_bytes_pop,
+     NULL, test_bytes_teardown},
+    {"mpmc", 4U, 4U, 0U, test_mpmc_setup, test_mpmc_push, test_mpmc_pop, NULL,
+     test_mpmc_teardown},
+    {"broadcast", 1U, 3U, TEST_BROADCAST, test_broadcast_setup,
+     test_broadcast_push, test_broadcast_pop, NULL, test_broadcast_teardown},
+    {"sharded", 4U, 2U, 0U, test_sharded_setup, test_sharded_push,
+     test_sharded_pop, NULL, test_sharded_teardown},
+    {"pool", 2U, 2U, 0U, test_pool_setup, test_pool_push, test_pool_pop, NULL,
+     test_pool_teardown},
+    {"mutex-mirror", 2U, 2U, 0U, test_mutex_mirror_setup, test_mutex_push,
+     test_mutex_pop, NULL, test_mutex_teardown},
+    {"spsc-mirror", 1U, 1U, 0U, test_spsc_mirror_setup, test_zero_copy_push,
+     test_zero_copy_pop, NULL, test_spsc_teardown},
+    {"spsc-drain", 1U, 1U, TEST_LOSSY, test_spsc_pow2_setup, test_spsc_push,
+     test_spsc_drain_pop, NULL, test_spsc_teardown},
+    {"bytes-drain", 1U, 1U, TEST_LOSSY | TEST_UNCOUNTED, test_bytes_setup,
+     test_bytes_push, test_bytes_drain_pop, NULL, test_bytes_teardown},
+    {"mpmc-overwrite", 2U, 2U, TEST_LOSSY, test_mpmc_setup,
+     test_overwrite_push, test_mpmc_pop, NULL, test_mpmc_teardown},
+    {"mpmc-drain", 2U, 2U, TEST_LOSSY, test_mpmc_setup, test_mpmc_push,
+     test_mpmc_drain_pop, NULL, test_mpmc_teardown},
+    {"broadcast-lossy", 1U, 3U, TEST_BROADCAST | TEST_LOSSY, test_lossy_setup,
+     test_broadcast_push, test_lossy_pop, NULL, test_broadcast_teardown},
+    {"shm-spsc", 1U, 1U, 0U, test_shm_spsc_setup, test_shm_push, test_shm_pop,
+     NULL, test_shm_teardown},
+    {"shm-mpmc", 4U, 4U, 0U, test_shm_mpmc_setup, test_shm_push, test_shm_pop,
+     NULL, test_shm_teardown},
+};
+
+/* Arguments handed to each test thread */
+typedef struct
+{
+    const test_variant_t *variant;
+    test_ctx_t *ctx;
+    uint32_t index; /* Producer or consumer index */
+} test_thread_args_t;
+
+/**
+ * @brief Producer thread: sends its sequence in randomly sized batches.
+ *
+ * @param args Pointer to the thread arguments.
+ * @return void* No return value.
+ */
+static void *test_producer(void *args)
+{
+    test_thread_args_t *targs = (test_thread_args_t *)args;
+    test_ctx_t *ctx = targs->ctx;
+    test_element_t elements[TEST_MAX_BATCH];
+    uint64_t rng = ctx->seed ^ ((uint64_t)(targs->index + 1U) << 32U);
+    uint64_t sent = 0U;
+
+    while (sent < ctx->messages)
+    {
+        uint64_t random = test_random(&rng);
+        uint32_t count = 1U + (uint32_t)(random % TEST_MAX_BATCH);
+
+        if (count > (ctx->messages - sent))
+        {
+            count = (uint32_t)(ctx->messages - sent);
+        }
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            elements[i].sequence = sent + i;
+            elements[i].producer = targs->index;
+            elements[i].check = test_check(sent + i, targs->index);
+        }
+
+        uint32_t pushed =
+            targs->variant->push(ctx, targs->index, elements, count);
+
+        sent += pushed;
+
+        /* Vary the interleaving, and never spin hard on a full ring */
+        if ((pushed == 0U) || (((random >> 32U) & 63U) == 0U))
+        {
+            (void)sched_yield();
+        }
+    }
+
+    if (targs->variant->flush != NULL)
+    {
+        targs->variant->flush(ctx, targs->index);
+    }
+
+    (void)atomic_fetch_add(&ctx->finished, 1U);
+
+    return NULL;
+}
+
+/**
+ * @brief Consumer thread: checks every element it receives.
+ *
+ * Elements of one producer must arrive in order at each consumer, and
+ * exactly in sequence when that consumer gets all of them. A lossy consumer
+ * stops once every producer is done and the ring is empty.
+ *
+ * @param args Pointer to the thread arguments.
+ * @return void* No return value.
+ */
+static void *test_consumer(void *args)
+{
+    test_thread_args_t *targs = (test_thread_args_t *)args;
+    test_ctx_t *ctx = targs->ctx;
+    test_element_t elements[TEST_MAX_BATCH];
+    uint64_t next[TEST_MAX_THREADS] = {0U};
+    uint64_t rng = ctx->seed ^ ((uint64_t)(targs->index + 1U) << 48U);
+    uint64_t total = (uint64_t)ctx->producers * ctx->messages;
+    uint64_t received = 0U;
+    int lossy = ((targs->variant->flags & TEST_LOSSY) != 0U);
+    int exact = !lossy && (ctx->deliveries == ctx->consumers);
+
+    for (;;)
+    {
+        /* Read before popping, so an empty pop after it is final */
+        int finished =
+            lossy && (atomic_load(&ctx->finished) == ctx->producers);
+
+        /* A broadcast consumer gets everything, others share the total */
+        if (!lossy && (exact ? (received >= total)
+                             : (atomic_load(&ctx->received) >= total)))
+        {
+            break;
+        }
+
+        uint64_t random = test_random(&rng);
+        uint32_t popped = targs->variant->pop(
+            ctx, targs->index, elements,
+            1U + (uint32_t)(random % TEST_MAX_BATCH));
+
+        if (finished && (popped == 0U))
+        {
+            break;
+        }
+
+        if ((popped == 0U) || (((random >> 32U) & 63U) == 0U))
+        {
+            (void)sched_yield();
+        }
+
+        for (uint32_t i = 0U; i < popped; i++)
+        {
+            const test_element_t *element = &elements[i];
+            uint32_t producer = element->producer;
+            uint64_t sequence = element->sequence;
+
+            if ((producer >= ctx->producers) || (sequence >= ctx->messages) ||
+                (element->check != test_check(sequence, producer)))
+            {
+                test_fail(ctx, "corrupted", producer, sequence);
+                continue;
+            }
+
+            if (atomic_fetch_add(&ctx->seen[(producer * ctx->messages) +
+                                            sequence],
+                                 1U) >= ctx->deliveries)
+            {
+                test_fail(ctx, "duplicated", producer, sequence);
+            }
+
+            if (exact ? (sequence != next[producer])
+                      : (sequence < next[producer]))
+            {
+                test_fail(ctx, exact ? "out of sequence" : "reordered",
+                          producer, sequence);
+            }
+
+            next[producer] = sequence + 1U;
+        }
+
+        received += popped;
+        (void)atomic_fetch_add(&ctx->received, popped);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Run one variant and check that every element arrived.
+ *
+ * @param variant Pointer to the variant to run.
+ * @param messages Messages sent by each producer.
+ * @param seed Seed of the random batch sizes and yields.
+ * @return int 0 if the run passed, -1 otherwise.
+ */
+static int test_run(const test_variant_t *variant, uint32_t messages,
+                    uint64_t seed)
+{
+    test_ctx_t *ctx = &test_ctx;
+    pthread_t producers[TEST_MAX_THREADS];
+    pthread_t consumers[TEST_MAX_THREADS];
+    test_thread_args_t producer_args[TEST_MAX_THREADS];
+    test_thread_args_t consumer_args[TEST_MAX_THREADS];
+
+    (void)memset(ctx, 0, sizeof(*ctx));
+    ctx->producers = variant->producers;
+    ctx->consumers = variant->consumers;
+    ctx->deliveries =
+        ((variant->flags & TEST_BROADCAST) != 0U) ? variant->consumers : 1U;
+    ctx->messages = messages;
+    ctx->seed = seed;
+    ctx->seen = calloc((size_t)ctx->producers * messages, sizeof(uint8_t));
+    atomic_init(&ctx->received, 0U);
+    atomic_init(&ctx->dropped, 0U);
+    atomic_init(&ctx->finished, 0U);
+    atomic_init(&ctx->failures, 0U);
+
+    if ((ctx->seen == NULL) ||
+        (pthread_mutex_init(&ctx->mutex, NULL) != 0))
+    {
+        free((void *)ctx->seen);
+        printf("%-16s could not allocate the run\n", variant->name);
+        return -1;
+    }
+
+    if (variant->setup(ctx) != 0)
+    {
+        printf("%-16s setup failed\n", variant->name);
+        (void)pthread_mutex_destroy(&ctx->mutex);
+        free((void *)ctx->seen);
+        return -1;
+    }
+
+    for (uint32_t i = 0U; i < ctx->consumers; i++)
+    {
+        consumer_args[i] = (test_thread_args_t){variant, ctx, i};
+        (void)pthread_create(&consumers[i], NULL, test_consumer,
+                             &consumer_args[i]);
+    }
+
+    for (uint32_t i = 0U; i < ctx->producers; i++)
+    {
+        producer_args[i] = (test_thread_args_t){variant, ctx, i};
+        (void)pthread_create(&producers[i], NULL, test_producer,
+                             &producer_args[i]);
+    }
+
+    for (uint32_t i = 0U; i < ctx->producers; i++)
+    {
+        (void)pthread_join(producers[i], NULL);
+    }
+
+    for (uint32_t i = 0U; i < ctx->consumers; i++)
+    {
+        (void)pthread_join(consumers[i], NULL);
+    }
+
+    uint64_t sent = (uint64_t)ctx->deliveries * ctx->producers * messages;
+    uint64_t received = atomic_load(&ctx->received);
+    uint64_t dropped = atomic_load(&ctx->dropped);
+
+    /* A lossy ring must account for every delivery it did not make */
+    if (((variant->flags & (TEST_LOSSY | TEST_UNCOUNTED)) == TEST_LOSSY) &&
+        ((received + dropped) != sent))
+    {
+        (void)atomic_fetch_add(&ctx->failures, 1U);
+        printf("    received %llu + dropped %llu != sent %llu\n",
+               (unsigned long long)received, (unsigned long long)dropped,
+               (unsigned long long)sent);
+    }
+
+    /* Whatever was not seen by every consumer it was meant for is lost */
+    for (uint64_t i = 0U; ((variant->flags & TEST_LOSSY) == 0U) &&
+                          (i < ((uint64_t)ctx->producers * messages));
+         i++)
+    {
+        if (atomic_load_explicit(&ctx->seen[i], memory_order_relaxed) !=
+            ctx->deliveries)
+        {
+            test_fail(ctx, "lost", (uint32_t)(i / messages), i % messages);
+        }
+    }
+
+    variant->teardown(ctx);
+    (void)pthread_mutex_destroy(&ctx->mutex);
+    free((void *)ctx->seen);
+
+    uint32_t failures = atomic_load(&ctx->failures);
+
+    printf("%-16s %u producer(s), %u consumer(s): %s", variant->name,
+           ctx->producers, ctx->consumers, (failures == 0U) ? "ok" : "FAILED");
+
+    if (failures != 0U)
+    {
+        printf(" (%u failures)", failures);
+    }
+
+    printf("\n");
+
+    return (failures == 0U) ? 0 : -1;
+}
+
+/* ------------------------- Single-threaded checks ------------------------ */
+
+/* Single-threaded check of an API or of a fixed bug, returning 0 if it holds */
+typedef struct
+{
+    const char *name;
+    int (*check)(void);
+} test_unit_t;
+
+/* Number n elements from first, as producer 0 would */
+static void test_number(test_element_t *elements, uint64_t first,
+                        ring_buffer_index_t n)
+{
+    for (ring_buffer_index_t i = 0U; i < n; i++)
+    {
+        elements[i].sequence = first + i;
+        elements[i].producer = 0U;
+        elements[i].check = test_check(first + i, 0U);
+    }
+}
+
+/* Check that n elements are numbered from first, returning 0 if they are */
+static int test_numbered(const test_element_t *elements, uint64_t first,
+                         ring_buffer_index_t n)
+{
+    for (ring_buffer_index_t i = 0U; i < n; i++)
+    {
+        if ((elements[i].sequence != (first + i)) ||
+            (elements[i].producer != 0U) ||
+            (elements[i].check != test_check(first + i, 0U)))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * The largest record accepted must fit once the ring is empty, even when
+ * head stands past offset 0 and the record needs a skip marker first.
+ */
+static int test_bytes_wrap_check(void)
+{
+    static _Alignas(RING_BUFFER_BYTES_ALIGN) uint8_t buffer[64];
+    static uint8_t payload[64];
+    ring_buffer_bytes_t bytes;
+    uint32_t size = 0U;
+
+    (void)memset(&bytes, 0, sizeof(bytes));
+
+    if ((ring_buffer_bytes_init(&bytes, sizeof(buffer), buffer) !=
+         RING_BUFFER_OK) ||
+        (ring_buffer_bytes_push(&bytes, payload, 8U) != RING_BUFFER_OK) ||
+        (ring_buffer_bytes_pop(&bytes, payload, sizeof(payload), &size) !=
+         RING_BUFFER_OK) ||
+        (ring_buffer_bytes_state(&bytes) != RING_BUFFER_EMPTY))
+    {
+        return -1;
+    }
+
+    /* Larger than the limit: rejected outright instead of never fitting */
+    if (ring_buffer_bytes_push(&bytes, payload,
+                               RING_BUFFER_BYTES_MAX_PAYLOAD(64U) + 1U) !=
+        RING_BUFFER_INVALID_PARAMS)
+    {
+        return -1;
+    }
+
+    if ((ring_buffer_bytes_push(&bytes, payload,
+                                RING_BUFFER_BYTES_MAX_PAYLOAD(64U)) !=
+         RING_BUFFER_OK) ||
+        (ring_buffer_bytes_pop(&bytes, payload, sizeof(payload), &size) !=
+         RING_BUFFER_OK) ||
+        (size != RING_BUFFER_BYTES_MAX_PAYLOAD(64U)))
+    {
+        return -1;
+    }
+
+    (void)ring_buffer_bytes_destroy(&bytes);
+
+    return 0;
+}
+
+/*
+ * Deferred pops must be handed back to the producer when a plain pop, bulk
+ * pop or peek of the same consumer finds the ring empty.
+ */
+static int test_deferred_empty_check(void)
+{
+    static uint8_t buffer[TEST_LENGTH * sizeof(test_element_t)];
+    test_element_t element = {0U, 0U, 0U};
+
+    for (uint32_t call = 0U; call < 3U; call++)
+    {
+        ring_buffer_spsc_t spsc;
+        ring_buffer_index_t n = 0U;
+        void *ptr = NULL;
+        ring_buffer_status_t status;
+
+        (void)memset(&spsc, 0, sizeof(spsc));
+
+        if (ring_buffer_spsc_init(&spsc, sizeof(test_element_t), TEST_LENGTH,
+                                  buffer) != RING_BUFFER_OK)
+        {
+            return -1;
+        }
+
+        for (uint32_t i = 0U; i < TEST_LENGTH; i++)
+        {
+            if (ring_buffer_spsc_push(&spsc, &element) != RING_BUFFER_OK)
+            {
+                return -1;
+            }
+        }
+
+        /* Drained, but with no batch set none of the room is handed back */
+        for (uint32_t i = 0U; i < TEST_LENGTH; i++)
+        {
+            if (ring_buffer_spsc_pop_deferred(&spsc, &element) !=
+                RING_BUFFER_OK)
+            {
+                return -1;
+            }
+        }
+
+        if (ring_buffer_spsc_push(&spsc, &element) != RING_BUFFER_FULL)
+        {
+            return -1;
+        }
+
+        if (call == 0U)
+        {
+            status = ring_buffer_spsc_pop(&spsc, &element);
+        }
+        else if (call == 1U)
+        {
+            status = ring_buffer_spsc_pop_n(&spsc, &element, 1U, &n);
+        }
+        else
+        {
+            status = ring_buffer_spsc_peek(&spsc, 1U, &ptr, &n);
+        }
+
+        if ((status != RING_BUFFER_EMPTY) ||
+            (ring_buffer_spsc_push(&spsc, &element) != RING_BUFFER_OK))
+        {
+            return -1;
+        }
+
+        (void)ring_buffer_spsc_destroy(&spsc);
+    }
+
+    return 0;
+}
+
+/*
+ * Lengths the index type cannot wrap around must be rejected, and a bulk
+ * transfer ending exactly at the end of an odd-length buffer must wrap.
+ */
+static int test_length_check(void)
+{
+    static uint8_t buffer[TEST_ODD_LENGTH * sizeof(test_element_t)];
+    test_element_t elements[TEST_ODD_LENGTH];
+    ring_buffer_t ring;
+    ring_buffer_index_t n = 0U;
+
+    (void)memset(&ring, 0, sizeof(ring));
+    (void)memset(elements, 0, sizeof(elements));
+
+    if (ring_buffer_init(&ring, sizeof(test_element_t),
+                         RING_BUFFER_INDEX_LENGTH_MAX + 1U,
+                         buffer) != RING_BUFFER_INVALID_PARAMS)
+    {
+        return -1;
+    }
+
+    if (ring_buffer_init(&ring, sizeof(test_element_t), TEST_ODD_LENGTH,
+                         buffer) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    for (uint32_t round = 0U; round < 3U; round++)
+    {
+        if ((ring_buffer_push_n(&ring, elements, TEST_ODD_LENGTH - round,
+                                &n) != RING_BUFFER_OK) ||
+            (n != (TEST_ODD_LENGTH - round)) ||
+            (ring_buffer_pop_n(&ring, elements, TEST_ODD_LENGTH, &n) !=
+             RING_BUFFER_OK) ||
+            (n != (TEST_ODD_LENGTH - round)) ||
+            (ring_buffer_state(&ring) != RING_BUFFER_EMPTY))
+        {
+            return -1;
+        }
+    }
+
+    (void)ring_buffer_destroy(&ring);
+
+    return 0;
+}
+
+/*
+ * Bulk and zero-copy transfers of a non-power-of-two SPSC ring must wrap
+ * its indices at twice the length even where index + n overflows them.
+ */
+static int test_bulk_wrap_check(void)
+{
+    static _Alignas(test_element_t) uint8_t
+        buffer[TEST_BULK_WRAP_LENGTH * sizeof(test_element_t)];
+    static test_element_t elements[TEST_BULK_WRAP_LENGTH];
+    ring_buffer_spsc_t spsc;
+    uint64_t next = 0U;
+    uint64_t popped = 0U;
+    ring_buffer_index_t n = 0U;
+    ring_buffer_index_t size = 0U;
+    void *ptr = NULL;
+
+    (void)memset(&spsc, 0, sizeof(spsc));
+
+    if (ring_buffer_spsc_init(&spsc, sizeof(test_element_t),
+                              TEST_BULK_WRAP_LENGTH, buffer) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    /* Rounds move the indices by under a length, so transfers start anywhere */
+    for (uint32_t round = 0U; round < 12U; round++)
+    {
+        ring_buffer_index_t room =
+            (ring_buffer_index_t)(TEST_BULK_WRAP_LENGTH - (next - popped));
+        ring_buffer_index_t peeked =
+            (ring_buffer_index_t)((TEST_BULK_WRAP_LENGTH / 4U) + round);
+        ring_buffer_index_t chunk =
+            (ring_buffer_index_t)(((3U * TEST_BULK_WRAP_LENGTH) / 5U) + round);
+
+        /* Fill the ring with one bulk push */
+        test_number(elements, next, room);
+
+        if ((ring_buffer_spsc_push_n(&spsc, elements, TEST_BULK_WRAP_LENGTH,
+                                     &n) != RING_BUFFER_OK) ||
+            (n != room) || (ring_buffer_spsc_state(&spsc) != RING_BUFFER_FULL))
+        {
+            return -1;
+        }
+
+        next += room;
+
+        /* Hand part of it back through peek and release */
+        for (ring_buffer_index_t left = peeked; left > 0U; left -= n)
+        {
+            if ((ring_buffer_spsc_peek(&spsc, left, &ptr, &n) !=
+                 RING_BUFFER_OK) ||
+                (test_numbered(ptr, popped, n) != 0) ||
+                (ring_buffer_spsc_release(&spsc, n) != RING_BUFFER_OK))
+            {
+                return -1;
+            }
+
+            popped += n;
+        }
+
+        /* Refill the freed slots through reserve and commit */
+        for (ring_buffer_index_t left = peeked; left > 0U; left -= n)
+        {
+            if (ring_buffer_spsc_reserve(&spsc, left, &ptr, &n) !=
+                RING_BUFFER_OK)
+            {
+                return -1;
+            }
+
+            test_number(ptr, next, n);
+
+            if (ring_buffer_spsc_commit(&spsc, n) != RING_BUFFER_OK)
+            {
+                return -1;
+            }
+
+            next += n;
+        }
+
+        /* Take the rest down with one bulk pop */
+        if ((ring_buffer_spsc_pop_n(&spsc, elements, chunk, &n) !=
+             RING_BUFFER_OK) ||
+            (n != chunk) || (test_numbered(elements, popped, n) != 0))
+        {
+            return -1;
+        }
+
+        popped += n;
+
+        if ((ring_buffer_spsc_size(&spsc, &size) != RING_BUFFER_OK) ||
+            (size != (next - popped)))
+        {
+            return -1;
+        }
+    }
+
+    (void)ring_buffer_spsc_destroy(&spsc);
+
+    return 0;
+}
+
+/*
+ * The priority queue pops the highest non-empty level first, in order
+ * within a level, and a bulk pop never mixes levels.
+ */
+static int test_priority_check(void)
+{
+    static const ring_buffer_index_t lengths[] = {4U, 2U, 3U};
+    static uint8_t buffers[3][4U * sizeof(test_element_t)];
+    ring_buffer_t rings[3];
+    ring_buffer_priority_t queue;
+    test_element_t elements[4];
+    ring_buffer_index_t n = 0U;
+    uint32_t level = 0U;
+    uint64_t size = 0U;
+    int failed;
+
+    (void)memset(rings, 0, sizeof(rings));
+    (void)memset(&queue, 0, sizeof(queue));
+
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        if (ring_buffer_init(&rings[i], sizeof(test_element_t), lengths[i],
+                             buffers[i]) != RING_BUFFER_OK)
+        {
+            return -1;
+        }
+    }
+
+    if (ring_buffer_priority_init(&queue, rings, 3U) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    /* Lowest level first, so that popping has to reorder them */
+    test_number(elements, 0U, 3U);
+    failed = (ring_buffer_priority_push_n(&queue, 2U, elements, 3U, &n) !=
+              RING_BUFFER_OK) ||
+             (n != 3U);
+    test_number(elements, 10U, 4U);
+    failed = failed ||
+             (ring_buffer_priority_push_n(&queue, 1U, elements, 4U, &n) !=
+              RING_BUFFER_OK) ||
+             (n != 2U) ||
+             (ring_buffer_priority_push(&queue, 1U, elements) !=
+              RING_BUFFER_FULL) ||
+             (ring_buffer_priority_push(&queue, 3U, elements) !=
+              RING_BUFFER_INVALID_PARAMS);
+    test_number(elements, 20U, 1U);
+    failed = failed ||
+             (ring_buffer_priority_push(&queue, 0U, elements) !=
+              RING_BUFFER_OK) ||
+             (ring_buffer_priority_size(&queue, &size) != RING_BUFFER_OK) ||
+             (size != 6U);
+
+    /* Level 0, then all of level 1 */
+    failed = failed ||
+             (ring_buffer_priority_pop(&queue, elements, &level) !=
+              RING_BUFFER_OK) ||
+             (level != 0U) || (test_numbered(elements, 20U, 1U) != 0) ||
+             (ring_buffer_priority_pop_n(&queue, elements, 4U, &n, &level) !=
+              RING_BUFFER_OK) ||
+             (n != 2U) || (level != 1U) ||
+             (test_numbered(elements, 10U, 2U) != 0);
+
+    /* A level can be drained out of turn */
+    test_number(elements, 21U, 1U);
+    failed = failed ||
+             (ring_buffer_priority_push(&queue, 0U, elements) !=
+              RING_BUFFER_OK) ||
+             (ring_buffer_priority_pop_level_n(&queue, 2U, elements, 1U,
+                                               &n) != RING_BUFFER_OK) ||
+             (n != 1U) || (test_numbered(elements, 0U, 1U) != 0);
+
+    /* The element pushed meanwhile comes before the rest of level 2 */
+    failed = failed ||
+             (ring_buffer_priority_pop_n(&queue, elements, 4U, &n, &level) !=
+              RING_BUFFER_OK) ||
+             (n != 1U) || (level != 0U) ||
+             (test_numbered(elements, 21U, 1U) != 0) ||
+             (ring_buffer_priority_pop_n(&queue, elements, 4U, &n, &level) !=
+              RING_BUFFER_OK) ||
+             (n != 2U) || (level != 2U) ||
+             (test_numbered(elements, 1U, 2U) != 0) ||
+             (ring_buffer_priority_state(&queue) != RING_BUFFER_EMPTY) ||
+             (ring_buffer_priority_pop(&queue, elements, &level) !=
+              RING_BUFFER_EMPTY);
+
+    (void)ring_buffer_priority_destroy(&queue);
+
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        (void)ring_buffer_destroy(&rings[i]);
+    }
+
+    return failed ? -1 : 0;
+}
+
+/* Push count elements with one bulk push and pop them with one bulk pop */
+static int test_ring_round_trip(ring_buffer_t *ring,
+                                ring_buffer_index_t count)
+{
+    test_element_t elements[TEST_LENGTH];
+    ring_buffer_index_t n = 0U;
+
+    test_number(elements, 0U, count);
+
+    return ((ring_buffer_push_n(ring, elements, count, &n) !=
+             RING_BUFFER_OK) ||
+            (n != count) ||
+            (ring_buffer_pop_n(ring, elements, TEST_LENGTH, &n) !=
+             RING_BUFFER_OK) ||
+            (n != count) || (test_numbered(elements, 0U, count) != 0))
+               ? -1 : 0;
+}
+
+/* Same as test_ring_round_trip(), for an SPSC ring */
+static int test_spsc_round_trip(ring_buffer_spsc_t *spsc,
+                                ring_buffer_index_t count)
+{
+    test_element_t elements[TEST_LENGTH];
+    ring_buffer_index_t n = 0U;
+
+    test_number(elements, 0U, count);
+
+    return ((ring_buffer_spsc_push_n(spsc, elements, count, &n) !=
+             RING_BUFFER_OK) ||
+            (n != count) ||
+            (ring_buffer_spsc_pop_n(spsc, elements, TEST_LENGTH, &n) !=
+             RING_BUFFER_OK) ||
+            (n != count) || (test_numbered(elements, 0U, count) != 0))
+               ? -1 : 0;
+}
+
+/*
+ * ring_buffer_create() and ring_buffer_spsc_create() allocate a working
+ * buffer with every option that has a fallback, and destroy frees it.
+ */
+static int test_create_check(void)
+{
+    static const ring_buffer_alloc_options_t options[] = {
+        {0U, RING_BUFFER_ALLOC_ANY_NODE},
+        {RING_BUFFER_ALLOC_PAGE_ALIGNED, RING_BUFFER_ALLOC_ANY_NODE},
+        {RING_BUFFER_ALLOC_THP, RING_BUFFER_ALLOC_ANY_NODE},
+        {RING_BUFFER_ALLOC_HUGETLB, RING_BUFFER_ALLOC_ANY_NODE},
+    };
+    static const ring_buffer_index_t lengths[] = {TEST_ODD_LENGTH,
+                                                  TEST_LENGTH};
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    ring_buffer_t ring;
+
+    (void)memset(&ring, 0, sizeof(ring));
+
+    if (ring_buffer_create(&ring, sizeof(test_element_t), 0U, NULL) !=
+        RING_BUFFER_INVALID_PARAMS)
+    {
+        return -1;
+    }
+
+    for (size_t o = 0U; o < (sizeof(options) / sizeof(options[0])); o++)
+    {
+        for (size_t l = 0U; l < (sizeof(lengths) / sizeof(lengths[0])); l++)
+        {
+            uintptr_t align = ((options[o].flags &
+                                RING_BUFFER_ALLOC_PAGE_ALIGNED) != 0U)
+                                  ? page
+                                  : RING_BUFFER_CACHE_LINE_SIZE;
+            ring_buffer_spsc_t spsc;
+            int failed;
+
+            (void)memset(&ring, 0, sizeof(ring));
+            (void)memset(&spsc, 0, sizeof(spsc));
+
+            if (ring_buffer_create(&ring, sizeof(test_element_t), lengths[l],
+                                   &options[o]) != RING_BUFFER_OK)
+            {
+                return -1;
+            }
+
+            failed = (((uintptr_t)ring.buffer % align) != 0U) ||
+                     (test_ring_round_trip(&ring, lengths[l]) != 0) ||
+                     (ring_buffer_create(&ring, sizeof(test_element_t),
+                                         lengths[l], &options[o]) !=
+                      RING_BUFFER_ALREADY_INITIALIZED);
+            failed |= (ring_buffer_destroy(&ring) != RING_BUFFER_OK);
+
+            if (failed ||
+                (ring_buffer_spsc_create(&spsc, sizeof(test_element_t),
+                                         lengths[l], &options[o]) !=
+                 RING_BUFFER_OK))
+            {
+                return -1;
+            }
+
+            failed = (((uintptr_t)spsc.buffer % align) != 0U) ||
+                     (test_spsc_round_trip(&spsc, lengths[l]) != 0);
+            failed |= (ring_buffer_spsc_destroy(&spsc) != RING_BUFFER_OK);
+
+            if (failed)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* ring_buffer_clear_secure() empties the ring and zeroes all of its memory */
+static int test_clear_secure_check(void)
+{
+    static uint8_t buffer[TEST_ODD_LENGTH * sizeof(test_element_t)];
+    test_element_t elements[TEST_ODD_LENGTH];
+    ring_buffer_t ring;
+    ring_buffer_index_t n = 0U;
+
+    (void)memset(&ring, 0, sizeof(ring));
+
+    if ((ring_buffer_clear_secure(NULL) != RING_BUFFER_INVALID_PARAMS) ||
+        (ring_buffer_clear_secure(&ring) != RING_BUFFER_NOT_INITIALIZED) ||
+        (ring_buffer_init(&ring, sizeof(test_element_t), TEST_ODD_LENGTH,
+                          buffer) != RING_BUFFER_OK))
+    {
+        return -1;
+    }
+
+    /* Leave head and tail off slot 0 with the ring full */
+    test_number(elements, 1U, TEST_ODD_LENGTH);
+
+    if ((ring_buffer_push_n(&ring, elements, 3U, &n) != RING_BUFFER_OK) ||
+        (ring_buffer_pop_n(&ring, elements, 3U, &n) != RING_BUFFER_OK) ||
+        (ring_buffer_push_n(&ring, elements, TEST_ODD_LENGTH, &n) !=
+         RING_BUFFER_OK) ||
+        (ring_buffer_clear_secure(&ring) != RING_BUFFER_OK) ||
+        (ring_buffer_state(&ring) != RING_BUFFER_EMPTY))
+    {
+        return -1;
+    }
+
+    for (size_t i = 0U; i < sizeof(buffer); i++)
+    {
+        if (buffer[i] != 0U)
+        {
+            return -1;
+        }
+    }
+
+    if (test_ring_round_trip(&ring, TEST_ODD_LENGTH) != 0)
+    {
+        return -1;
+    }
+
+    (void)ring_buffer_destroy(&ring);
+
+    return 0;
+}
+
+#ifdef RING_BUFFER_ENABLE_LATENCY
+/* Check that a histogram holds count dwell times */
+static int test_latency_counted(const ring_buffer_latency_t *latency,
+                                uint64_t count)
+{
+    uint64_t sum = 0U;
+
+    for (uint32_t i = 0U; i < RING_BUFFER_LATENCY_BUCKETS; i++)
+    {
+        sum += latency->buckets[i];
+    }
+
+    return ((latency->count == count) && (sum == count) &&
+            (latency->max <= latency->total))
+               ? 0 : -1;
+}
+#endif
+
+/*
+ * Dwell-time histograms count every element popped while stamps are set,
+ * and report RING_BUFFER_FAIL when they are compiled out.
+ */
+static int test_latency_check(void)
+{
+    static uint8_t ring_buffer[TEST_ODD_LENGTH * sizeof(test_element_t)];
+    static uint8_t spsc_buffer[TEST_ODD_LENGTH * sizeof(test_element_t)];
+    static uint64_t ring_stamps[TEST_ODD_LENGTH];
+    static uint64_t spsc_stamps[TEST_ODD_LENGTH];
+    ring_buffer_t ring;
+    ring_buffer_spsc_t spsc;
+    ring_buffer_latency_t latency;
+    int failed;
+
+    (void)memset(&ring, 0, sizeof(ring));
+    (void)memset(&spsc, 0, sizeof(spsc));
+
+    if ((ring_buffer_init(&ring, sizeof(test_element_t), TEST_ODD_LENGTH,
+                          ring_buffer) != RING_BUFFER_OK) ||
+        (ring_buffer_spsc_init(&spsc, sizeof(test_element_t), TEST_ODD_LENGTH,
+                               spsc_buffer) != RING_BUFFER_OK))
+    {
+        return -1;
+    }
+
+#ifdef RING_BUFFER_ENABLE_LATENCY
+    /* Two round trips, so the second one wraps around the buffer end */
+    failed = (ring_buffer_set_latency_stamps(&ring, ring_stamps) !=
+              RING_BUFFER_OK) ||
+             (test_ring_round_trip(&ring, 3U) != 0) ||
+             (test_ring_round_trip(&ring, TEST_ODD_LENGTH) != 0) ||
+             (ring_buffer_latency(&ring, &latency) != RING_BUFFER_OK) ||
+             (test_latency_counted(&latency, 3U + TEST_ODD_LENGTH) != 0);
+    failed = failed ||
+             (ring_buffer_spsc_set_latency_stamps(&spsc, spsc_stamps) !=
+              RING_BUFFER_OK) ||
+             (test_spsc_round_trip(&spsc, 3U) != 0) ||
+             (test_spsc_round_trip(&spsc, TEST_ODD_LENGTH) != 0) ||
+             (ring_buffer_spsc_latency(&spsc, &latency) != RING_BUFFER_OK) ||
+             (test_latency_counted(&latency, 3U + TEST_ODD_LENGTH) != 0);
+
+    /* Without stamps nothing more is recorded */
+    failed = failed ||
+             (ring_buffer_set_latency_stamps(&ring, NULL) != RING_BUFFER_OK) ||
+             (test_ring_round_trip(&ring, 3U) != 0) ||
+             (ring_buffer_latency(&ring, &latency) != RING_BUFFER_OK) ||
+             (test_latency_counted(&latency, 3U + TEST_ODD_LENGTH) != 0);
+#else
+    failed = (ring_buffer_set_latency_stamps(&ring, ring_stamps) !=
+              RING_BUFFER_FAIL) ||
+             (ring_buffer_spsc_set_latency_stamps(&spsc, spsc_stamps) !=
+              RING_BUFFER_FAIL) ||
+             (ring_buffer_latency(&ring, &latency) != RING_BUFFER_FAIL) ||
+             (ring_buffer_spsc_latency(&spsc, &latency) != RING_BUFFER_FAIL);
+#endif
+
+    (void)ring_buffer_destroy(&ring);
+    (void)ring_buffer_spsc_destroy(&spsc);
+
+    return failed ? -1 : 0;
+}
+
+/* Path of the ring file used by the checks, unique to this process */
+static void test_file_path(char *path, size_t size)
+{
+    (void)snprintf(path, size, "/tmp/ring_buffer_test_%ld.rbf",
+                   (long)getpid());
+}
+
+/* Push count elements numbered from first into a file ring */
+static int test_file_fill(ring_buffer_file_t *file, uint64_t first,
+                          uint32_t count)
+{
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        test_element_t element = {first + i, 0U, test_check(first + i, 0U)};
+
+        if (ring_buffer_push(&file->ring, &element) != RING_BUFFER_OK)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Pop count elements from a file ring, expecting them numbered from first */
+static int test_file_drain(ring_buffer_file_t *file, uint64_t first,
+                           uint32_t count)
+{
+    test_element_t element;
+
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        if ((ring_buffer_file_pop(file, &element) != RING_BUFFER_OK) ||
+            (element.sequence != (first + i)) ||
+            (element.check != test_check(first + i, 0U)))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Pops of a file ring keep their slots until the next sync, so a reopen
+ * after a crash replays exactly the unsynced pops, in order.
+ */
+static int test_file_replay_check(void)
+{
+    char path[64];
+    ring_buffer_file_t file;
+    ring_buffer_file_t replay;
+    test_element_t element = {0U, 0U, 0U};
+    int failed;
+
+    test_file_path(path, sizeof(path));
+    (void)unlink(path);
+    (void)memset(&file, 0, sizeof(file));
+    (void)memset(&replay, 0, sizeof(replay));
+
+    if (ring_buffer_file_open(&file, path, sizeof(test_element_t),
+                              TEST_ODD_LENGTH) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    /* Move the synced tail off slot 0 so the replayed range wraps */
+    failed = (test_file_fill(&file, 0U, 5U) != 0) ||
+             (test_file_drain(&file, 0U, 5U) != 0) ||
+             (ring_buffer_file_sync(&file) != RING_BUFFER_OK) ||
+             (test_file_fill(&file, 5U, TEST_ODD_LENGTH) != 0) ||
+             (ring_buffer_file_sync(&file) != RING_BUFFER_OK) ||
+             (test_file_drain(&file, 5U, 2U) != 0) ||
+             (ring_buffer_push(&file.ring, &element) != RING_BUFFER_FULL);
+
+    /* Reopening without a sync stands in for a crash */
+    if (!failed &&
+        (ring_buffer_file_open(&replay, path, sizeof(test_element_t),
+                               TEST_ODD_LENGTH) == RING_BUFFER_OK))
+    {
+        failed = (test_file_drain(&replay, 5U, TEST_ODD_LENGTH) != 0) ||
+                 (ring_buffer_file_pop(&replay, &element) !=
+                  RING_BUFFER_EMPTY);
+        (void)ring_buffer_file_close(&replay);
+    }
+    else
+    {
+        failed = 1;
+    }
+
+    /* Synced pops hand their slots back */
+    failed = failed || (ring_buffer_file_sync(&file) != RING_BUFFER_OK) ||
+             (test_file_fill(&file, 5U + TEST_ODD_LENGTH, 2U) != 0);
+
+    (void)ring_buffer_file_close(&file);
+    (void)unlink(path);
+
+    return failed ? -1 : 0;
+}
+
+/* Flip a byte of the checksum of one header copy of a closed ring file */
+static int test_file_corrupt(const char *path, uint32_t copy)
+{
+    long offset = (long)((copy * sizeof(ring_buffer_file_header_t)) +
+                         offsetof(ring_buffer_file_header_t, checksum));
+    FILE *file = fopen(path, "r+b");
+    int byte = EOF;
+    int failed;
+
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    failed = (fseek(file, offset, SEEK_SET) != 0) ||
+             ((byte = fgetc(file)) == EOF) ||
+             (fseek(file, offset, SEEK_SET) != 0) ||
+             (fputc(byte ^ 0xFF, file) == EOF);
+    failed |= (fclose(file) != 0);
+
+    return failed ? -1 : 0;
+}
+
+/*
+ * A closed ring file reopens with the elements it held, refuses another
+ * geometry, survives one bad header copy and is rejected with two.
+ */
+static int test_file_reopen_check(void)
+{
+    char path[64];
+    ring_buffer_file_t file;
+    test_element_t element = {0U, 0U, 0U};
+    int failed;
+
+    test_file_path(path, sizeof(path));
+    (void)unlink(path);
+    (void)memset(&file, 0, sizeof(file));
+
+    if (ring_buffer_file_open(&file, path, sizeof(test_element_t),
+                              TEST_ODD_LENGTH) != RING_BUFFER_OK)
+    {
+        return -1;
+    }
+
+    failed = (test_file_fill(&file, 0U, 5U) != 0) ||
+             (test_file_drain(&file, 0U, 2U) != 0);
+    failed |= (ring_buffer_file_close(&file) != RING_BUFFER_OK);
+
+    failed = failed ||
+             (ring_buffer_file_open(&file, path, sizeof(test_element_t),
+                                    TEST_LENGTH) !=
+              RING_BUFFER_INVALID_PARAMS) ||
+             (ring_buffer_file_open(&file, path, sizeof(test_element_t),
+                                    TEST_ODD_LENGTH) != RING_BUFFER_OK);
+
+    if (!failed)
+    {
+        failed = (test_file_drain(&file, 2U, 3U) != 0) ||
+                 (ring_buffer_file_pop(&file, &element) != RING_BUFFER_EMPTY);
+        failed |= (ring_buffer_file_close(&file) != RING_BUFFER_OK);
+    }
+
+    /* The other copy of the header stands in for a damaged one */
+    failed = failed || (test_file_corrupt(path, 0U) != 0) ||
+             (ring_buffer_file_open(&file, path, sizeof(test_element_t),
+                                    TEST_ODD_LENGTH) != RING_BUFFER_OK) ||
+             (ring_buffer_file_close(&file) != RING_BUFFER_OK);
+
+    failed = failed || (test_file_corrupt(path, 0U) != 0) ||
+             (test_file_corrupt(path, 1U) != 0) ||
+             (ring_buffer_file_open(&file, path, sizeof(test_element_t),
+                                    TEST_ODD_LENGTH) != RING_BUFFER_FAIL);
+
+    (void)unlink(path);
+
+    return failed ? -1 : 0;
+}
+
+/* Table of single-threaded checks */
+static const test_unit_t test_units[] = {
+    {"bytes-wrap", test_bytes_wrap_check},
+    {"deferred-empty", test_deferred_empty_check},
+    {"ring-length", test_length_check},
+    {"bulk-wrap", test_bulk_wrap_check},
+    {"priority", test_priority_check},
+    {"create", test_create_check},
+    {"clear-secure", test_clear_secure_check},
+    {"latency", test_latency_check},
+    {"file-replay", test_file_replay_check},
+    {"file-reopen", test_file_reopen_check},
+};
+
+/* Run every single-threaded check, returning 0 if all of them pass */
+static int test_run_units(void)
+{
+    int failed = 0;
+
+    for (size_t i = 0U; i < (sizeof(test_units) / sizeof(test_units[0]));
+         i++)
+    {
+        int ok = (test_units[i].check() == 0);
+
+        printf("%-16s check: %s\n", test_units[i].name,
+               ok ? "ok" : "FAILED");
+        failed |= !ok;
+    }
+
+    return failed ? -1 : 0;
+}
+
+/**
+ * @brief Main function: run the single-threaded checks, then stress every
+ * variant.
+ *
+ * Usage: test.exe [messages per producer] [seed]. The seed is printed so
+ * a failing run can be repeated.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments.
+ * @return int 0 if every check and variant passed, 1 otherwise.
+ */
+int main(int argc, char **argv)
+{
+    uint32_t messages = TEST_DEFAULT_MESSAGES;
+    uint64_t seed = (uint64_t)time(NULL);
+    int failed = 0;
+
+    if (argc > 1)
+    {
+        messages = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        seed = strtoull(argv[2], NULL, 10);
+    }
+
+    if (messages == 0U)
+    {
+        messages = TEST_DEFAULT_MESSAGES;
+    }
+
+    /* xorshift needs a non-zero state */
+    seed = (seed == 0U) ? 1U : seed;
+
+    printf("Stress test: %u messages per producer, seed %llu, "
+           "%u-bit indices\n",
+           messages, (unsigned long long)seed,
+           (unsigned)RING_BUFFER_INDEX_BITS);
+
+    if (test_run_units() != 0)
+    {
+        failed = 1;
+    }
+
+    for (size_t i = 0U; i < (sizeof(test_variants) / sizeof(test_variants[0]));
+         i++)
+    {
+        if (test_run(&test_variants[i], messages, seed) != 0)
+        {
+            failed = 1;
+        }
+    }
+
+    printf("%s\n", failed ? "Stress test FAILED" : "Stress test passed");
+
+    return failed;
+}